@@ -3,6 +3,7 @@ INCLUDEPATH += $$PWD
 HEADERS += \
     $$PWD/application.h \
     $$PWD/applicationinstancemanager.h \
+    $$PWD/completionhookexecutor.h \
     $$PWD/cmdoptions.h \
     $$PWD/filelogger.h \
     $$PWD/qtlocalpeer/qtlocalpeer.h \
@@ -11,6 +12,7 @@ HEADERS += \
 SOURCES += \
     $$PWD/application.cpp \
     $$PWD/applicationinstancemanager.cpp \
+    $$PWD/completionhookexecutor.cpp \
     $$PWD/cmdoptions.cpp \
     $$PWD/filelogger.cpp \
     $$PWD/main.cpp \
@@ -34,16 +34,13 @@
 #include <algorithm>
 
 #ifdef Q_OS_WIN
-#include <memory>
 #include <Windows.h>
-#include <Shellapi.h>
 #endif
 
 #include <QAtomicInt>
 #include <QDebug>
 #include <QDir>
 #include <QLibraryInfo>
-#include <QProcess>
 
 #ifndef DISABLE_GUI
 #include <QMessageBox>
@@ -71,7 +68,6 @@
 #include "base/net/downloadmanager.h"
 #include "base/net/geoipmanager.h"
 #include "base/net/proxyconfigurationmanager.h"
-#include "base/net/smtp.h"
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/rss/rss_autodownloader.h"
@@ -81,8 +77,8 @@
 #include "base/settingsstorage.h"
 #include "base/utils/fs.h"
 #include "base/utils/misc.h"
-#include "base/utils/string.h"
 #include "applicationinstancemanager.h"
+#include "completionhookexecutor.h"
 #include "filelogger.h"
 
 #ifndef DISABLE_WEBUI
@@ -125,6 +121,7 @@ Application::Application(const QString &id, int &argc, char **argv)
 #ifndef DISABLE_WEBUI
     , m_webui(nullptr)
 #endif
+    , m_completionHookExecutor(nullptr)
 {
     qRegisterMetaType<Log::Msg>("Log::Msg");
 
@@ -284,97 +281,9 @@ void Application::processMessage(const QString &message)
         m_paramsQueue.append(params);
 }
 
-void Application::runExternalProgram(const BitTorrent::TorrentHandle *torrent) const
-{
-    QString program = Preferences::instance()->getAutoRunProgram().trimmed();
-    program.replace("%N", torrent->name());
-    program.replace("%L", torrent->category());
-
-    QStringList tags = torrent->tags().toList();
-    std::sort(tags.begin(), tags.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
-    program.replace("%G", tags.join(','));
-
-#if defined(Q_OS_WIN)
-    const auto chopPathSep = [](const QString &str) -> QString
-    {
-        if (str.endsWith('\\'))
-            return str.mid(0, (str.length() -1));
-        return str;
-    };
-    program.replace("%F", chopPathSep(Utils::Fs::toNativePath(torrent->contentPath())));
-    program.replace("%R", chopPathSep(Utils::Fs::toNativePath(torrent->rootPath())));
-    program.replace("%D", chopPathSep(Utils::Fs::toNativePath(torrent->savePath())));
-#else
-    program.replace("%F", Utils::Fs::toNativePath(torrent->contentPath()));
-    program.replace("%R", Utils::Fs::toNativePath(torrent->rootPath()));
-    program.replace("%D", Utils::Fs::toNativePath(torrent->savePath()));
-#endif
-    program.replace("%C", QString::number(torrent->filesCount()));
-    program.replace("%Z", QString::number(torrent->totalSize()));
-    program.replace("%T", torrent->currentTracker());
-    program.replace("%I", torrent->hash());
-
-    Logger *logger = Logger::instance();
-    logger->addMessage(tr("Torrent: %1, running external program, command: %2").arg(torrent->name(), program));
-
-#if defined(Q_OS_WIN)
-    std::unique_ptr<wchar_t[]> programWchar(new wchar_t[program.length() + 1] {});
-    program.toWCharArray(programWchar.get());
-
-    // Need to split arguments manually because QProcess::startDetached(QString)
-    // will strip off empty parameters.
-    // E.g. `python.exe "1" "" "3"` will become `python.exe "1" "3"`
-    int argCount = 0;
-    LPWSTR *args = ::CommandLineToArgvW(programWchar.get(), &argCount);
-
-    QStringList argList;
-    for (int i = 1; i < argCount; ++i)
-        argList += QString::fromWCharArray(args[i]);
-
-    QProcess::startDetached(QString::fromWCharArray(args[0]), argList);
-
-    ::LocalFree(args);
-#else
-    // Cannot give users shell environment by default, as doing so could
-    // enable command injection via torrent name and other arguments
-    // (especially when some automated download mechanism has been setup).
-    // See: https://github.com/qbittorrent/qBittorrent/issues/10925
-    QProcess::startDetached(program);
-#endif
-}
-
-void Application::sendNotificationEmail(const BitTorrent::TorrentHandle *torrent)
-{
-    // Prepare mail content
-    const QString content = tr("Torrent name: %1").arg(torrent->name()) + '\n'
-        + tr("Torrent size: %1").arg(Utils::Misc::friendlyUnit(torrent->wantedSize())) + '\n'
-        + tr("Save path: %1").arg(torrent->savePath()) + "\n\n"
-        + tr("The torrent was downloaded in %1.", "The torrent was downloaded in 1 hour and 20 seconds")
-            .arg(Utils::Misc::userFriendlyDuration(torrent->activeTime())) + "\n\n\n"
-        + tr("Thank you for using qBittorrent.") + '\n';
-
-    // Send the notification email
-    const Preferences *pref = Preferences::instance();
-    auto *smtp = new Net::Smtp(this);
-    smtp->sendMail(pref->getMailNotificationSender(),
-                     pref->getMailNotificationEmail(),
-                     tr("[qBittorrent] '%1' has finished downloading").arg(torrent->name()),
-                     content);
-}
-
 void Application::torrentFinished(BitTorrent::TorrentHandle *const torrent)
 {
-    Preferences *const pref = Preferences::instance();
-
-    // AutoRun program
-    if (pref->isAutoRunEnabled())
-        runExternalProgram(torrent);
-
-    // Mail notification
-    if (pref->isMailNotificationEnabled()) {
-        Logger::instance()->addMessage(tr("Torrent: %1, sending mail notification").arg(torrent->name()));
-        sendNotificationEmail(torrent);
-    }
+    m_completionHookExecutor->torrentFinished(torrent);
 }
 
 void Application::allTorrentsFinished()
@@ -506,6 +415,7 @@ int Application::exec(const QStringList &params)
 
     try {
         BitTorrent::Session::initInstance();
+        m_completionHookExecutor = new CompletionHookExecutor(this);
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentFinished, this, &Application::torrentFinished);
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::allTorrentsFinished, this, &Application::allTorrentsFinished, Qt::QueuedConnection);
 
@@ -706,6 +616,8 @@ void Application::cleanup()
 
     ScanFoldersModel::freeInstance();
     BitTorrent::Session::freeInstance();
+    delete m_completionHookExecutor;
+    m_completionHookExecutor = nullptr;
 #ifndef DISABLE_COUNTRIES_RESOLUTION
     Net::GeoIPManager::freeInstance();
 #endif
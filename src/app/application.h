@@ -55,6 +55,7 @@ class WebUI;
 #endif
 
 class ApplicationInstanceManager;
+class CompletionHookExecutor;
 class FileLogger;
 
 namespace BitTorrent
@@ -133,6 +134,8 @@ private:
     WebUI *m_webui;
 #endif
 
+    CompletionHookExecutor *m_completionHookExecutor;
+
     // FileLog
     QPointer<FileLogger> m_fileLogger;
 
@@ -142,7 +145,5 @@ private:
 
     void initializeTranslation();
     void processParams(const QStringList &params);
-    void runExternalProgram(const BitTorrent::TorrentHandle *torrent) const;
-    void sendNotificationEmail(const BitTorrent::TorrentHandle *torrent);
     void validateCommandLineParameters();
 };
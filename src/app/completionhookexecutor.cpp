@@ -0,0 +1,510 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "completionhookexecutor.h"
+
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <memory>
+#include <Windows.h>
+#include <Shellapi.h>
+#endif
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QProcess>
+#include <QTimer>
+#include <QUrl>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrenthandle.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/net/smtp.h"
+#include "base/preferences.h"
+#include "base/utils/fs.h"
+#include "base/utils/misc.h"
+#include "base/utils/string.h"
+
+namespace
+{
+    const int RETRY_DELAY = 5000; // msecs, doubled on every attempt
+    const int WEBHOOK_BATCH_DELAY = 2000; // msecs
+    const int WEBHOOK_MAX_BATCH_SIZE = 100;
+    const int WEBHOOK_TIMEOUT = 30000; // msecs
+
+    // 0 if jobs can run as long as they need
+    int jobTimeout()
+    {
+        return (Preferences::instance()->getCompletionHookTimeout() * 1000);
+    }
+
+    QString hookName(const CompletionHookExecutor::HookType type)
+    {
+        switch (type) {
+        case CompletionHookExecutor::HookType::ExternalProgram:
+            return CompletionHookExecutor::tr("external program");
+        case CompletionHookExecutor::HookType::Email:
+            return CompletionHookExecutor::tr("email notification");
+        case CompletionHookExecutor::HookType::Webhook:
+            return CompletionHookExecutor::tr("webhook");
+        default:
+            return {};
+        }
+    }
+}
+
+CompletionHookExecutor::CompletionHookExecutor(QObject *parent)
+    : QObject(parent)
+    , m_webhookBatchTimer(new QTimer(this))
+    , m_networkManager(new QNetworkAccessManager(this))
+{
+    // webhooks are expected to be local services
+    m_networkManager->setProxy(QNetworkProxy::NoProxy);
+
+    m_webhookBatchTimer->setSingleShot(true);
+    m_webhookBatchTimer->setInterval(WEBHOOK_BATCH_DELAY);
+    connect(m_webhookBatchTimer, &QTimer::timeout, this, &CompletionHookExecutor::flushWebhookBatch);
+}
+
+CompletionHookExecutor::~CompletionHookExecutor()
+{
+    // External programs used to be started detached, don't kill the ones still running
+    for (QProcess *process : asConst(m_runningProcesses)) {
+        process->disconnect(this);
+        process->setParent(nullptr);
+    }
+
+    // There is no event loop left to run anything else
+    if (!m_webhookBatch.isEmpty()) {
+        LogMsg(tr("Discarded webhook call for %1 finished torrent(s)").arg(m_webhookBatch.size())
+            , Log::WARNING);
+    }
+    const int discardedJobs = pendingJobs() - m_runningProcesses.size();
+    if (discardedJobs > 0)
+        LogMsg(tr("Discarded %1 unfinished torrent completion action(s)").arg(discardedJobs), Log::WARNING);
+
+    logStatistics();
+}
+
+void CompletionHookExecutor::torrentFinished(const BitTorrent::TorrentHandle *torrent)
+{
+    const Preferences *pref = Preferences::instance();
+    const bool runProgram = pref->isAutoRunEnabled();
+    const bool sendEmail = pref->isMailNotificationEnabled();
+    const bool callWebhook = !pref->getCompletionWebhookURL().isEmpty();
+    if (!runProgram && !sendEmail && !callWebhook)
+        return;
+
+    QStringList tags = torrent->tags().toList();
+    std::sort(tags.begin(), tags.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
+
+    const TorrentData data {
+        torrent->hash(), torrent->name(), torrent->category(), tags
+        , torrent->contentPath(), torrent->rootPath(), torrent->savePath(), torrent->currentTracker()
+        , torrent->filesCount(), torrent->totalSize(), torrent->wantedSize(), torrent->activeTime()};
+
+    if (runProgram) {
+        Job job;
+        job.type = HookType::ExternalProgram;
+        job.torrents = {data};
+        enqueue(job);
+    }
+
+    if (sendEmail) {
+        LogMsg(tr("Torrent: %1, sending mail notification").arg(data.name));
+
+        Job job;
+        job.type = HookType::Email;
+        job.torrents = {data};
+        enqueue(job);
+    }
+
+    if (callWebhook) {
+        // torrents finishing together are reported in a single call
+        m_webhookBatch.append(data);
+        if (m_webhookBatch.size() >= WEBHOOK_MAX_BATCH_SIZE)
+            flushWebhookBatch();
+        else if (!m_webhookBatchTimer->isActive())
+            m_webhookBatchTimer->start();
+    }
+}
+
+int CompletionHookExecutor::pendingJobs() const
+{
+    return (m_queue.size() + m_runningJobs + m_delayedJobs);
+}
+
+void CompletionHookExecutor::enqueue(const Job &job)
+{
+    m_queue.enqueue(job);
+    startJobs();
+}
+
+void CompletionHookExecutor::startJobs()
+{
+    const int maxJobs = Preferences::instance()->getCompletionHookMaxJobs();
+    while ((m_runningJobs < maxJobs) && !m_queue.isEmpty())
+        startJob(m_queue.dequeue());
+}
+
+void CompletionHookExecutor::startJob(Job job)
+{
+    ++m_runningJobs;
+    job.timer.start();
+
+    switch (job.type) {
+    case HookType::ExternalProgram:
+        runExternalProgram(job);
+        break;
+    case HookType::Email:
+        sendNotificationEmail(job);
+        break;
+    case HookType::Webhook:
+        postWebhook(job);
+        break;
+    default:
+        Q_ASSERT(false);
+        --m_runningJobs;
+        break;
+    }
+}
+
+void CompletionHookExecutor::finishJob(Job job, const bool success, const bool canRetry, const QString &error)
+{
+    --m_runningJobs;
+
+    Statistics &stats = m_statistics[static_cast<int>(job.type)];
+    const qint64 latency = job.timer.elapsed();
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+
+    if (success) {
+        ++stats.succeeded;
+    }
+    else if (canRetry && (job.attempt < Preferences::instance()->getCompletionHookMaxRetries())) {
+        ++stats.retried;
+        LogMsg(tr("Couldn't run %1 for torrent \"%2\", retrying. Attempt: %3. Error: %4")
+            .arg(hookName(job.type), job.torrents.first().name, QString::number(job.attempt + 1), error), Log::WARNING);
+
+        const int delay = RETRY_DELAY * (1 << job.attempt);
+        ++job.attempt;
+        ++m_delayedJobs;
+        QTimer::singleShot(delay, this, [this, job]()
+        {
+            --m_delayedJobs;
+            enqueue(job);
+        });
+    }
+    else {
+        ++stats.failed;
+        LogMsg(tr("Couldn't run %1 for torrent \"%2\". Error: %3")
+            .arg(hookName(job.type), job.torrents.first().name, error), Log::CRITICAL);
+    }
+
+    startJobs();
+
+    if (pendingJobs() == 0)
+        logStatistics();
+}
+
+void CompletionHookExecutor::flushWebhookBatch()
+{
+    m_webhookBatchTimer->stop();
+    if (m_webhookBatch.isEmpty())
+        return;
+
+    Job job;
+    job.type = HookType::Webhook;
+    job.torrents = m_webhookBatch;
+    m_webhookBatch.clear();
+    enqueue(job);
+}
+
+void CompletionHookExecutor::logStatistics() const
+{
+    for (int i = 0; i < static_cast<int>(HookType::Count); ++i) {
+        const Statistics &stats = m_statistics[i];
+        const quint64 attempts = stats.succeeded + stats.failed + stats.retried;
+        if (attempts == 0)
+            continue;
+
+        LogMsg(tr("Torrent completion action statistics for %1: %2 succeeded, %3 failed, %4 retried, average time: %5 ms, longest: %6 ms")
+            .arg(hookName(static_cast<HookType>(i)), QString::number(stats.succeeded), QString::number(stats.failed)
+                , QString::number(stats.retried), QString::number(stats.totalLatency / attempts)
+                , QString::number(stats.maxLatency)));
+    }
+}
+
+void CompletionHookExecutor::runExternalProgram(Job job)
+{
+    const TorrentData &torrent = job.torrents.first();
+    const QString program = expandPlaceholders(Preferences::instance()->getAutoRunProgram().trimmed(), torrent);
+
+    LogMsg(tr("Torrent: %1, running external program, command: %2").arg(torrent.name, program));
+
+    auto *process = new QProcess(this);
+    // nobody reads the output, don't let it pile up
+    process->setStandardOutputFile(QProcess::nullDevice());
+    process->setStandardErrorFile(QProcess::nullDevice());
+    m_runningProcesses.insert(process);
+
+    // optionally, a hung program mustn't hold on to its slot nor delay the other actions
+    auto *timeoutTimer = new QTimer(process);
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, [this, process, job]()
+    {
+        process->disconnect(this);
+        m_runningProcesses.remove(process);
+        process->kill();
+        process->deleteLater();
+        finishJob(job, false, false, tr("Timed out"));
+    });
+    if (jobTimeout() > 0)
+        timeoutTimer->start(jobTimeout());
+
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this
+        , [this, process, job, timeoutTimer](const int exitCode, const QProcess::ExitStatus exitStatus)
+    {
+        timeoutTimer->stop();
+        m_runningProcesses.remove(process);
+        process->deleteLater();
+
+        // the program did run, running it again could repeat its side effects
+        const bool success = ((exitStatus == QProcess::NormalExit) && (exitCode == 0));
+        finishJob(job, success, false
+            , ((exitStatus == QProcess::NormalExit) ? tr("Exit code: %1").arg(exitCode) : process->errorString()));
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process, job, timeoutTimer](const QProcess::ProcessError error)
+    {
+        // other errors are followed by finished()
+        if (error != QProcess::FailedToStart)
+            return;
+
+        timeoutTimer->stop();
+        m_runningProcesses.remove(process);
+        process->deleteLater();
+        finishJob(job, false, true, process->errorString());
+    });
+
+#if defined(Q_OS_WIN)
+    std::unique_ptr<wchar_t[]> programWchar(new wchar_t[program.length() + 1] {});
+    program.toWCharArray(programWchar.get());
+
+    // Need to split arguments manually because QProcess::start(QString)
+    // will strip off empty parameters.
+    // E.g. `python.exe "1" "" "3"` will become `python.exe "1" "3"`
+    int argCount = 0;
+    LPWSTR *args = ::CommandLineToArgvW(programWchar.get(), &argCount);
+
+    QStringList argList;
+    for (int i = 1; i < argCount; ++i)
+        argList += QString::fromWCharArray(args[i]);
+
+    process->start(QString::fromWCharArray(args[0]), argList);
+
+    ::LocalFree(args);
+#else
+    // Cannot give users shell environment by default, as doing so could
+    // enable command injection via torrent name and other arguments
+    // (especially when some automated download mechanism has been setup).
+    // See: https://github.com/qbittorrent/qBittorrent/issues/10925
+    process->start(program);
+#endif
+}
+
+void CompletionHookExecutor::sendNotificationEmail(Job job)
+{
+    const TorrentData &torrent = job.torrents.first();
+
+    // Prepare mail content
+    const QString content = tr("Torrent name: %1").arg(torrent.name) + '\n'
+        + tr("Torrent size: %1").arg(Utils::Misc::friendlyUnit(torrent.wantedSize)) + '\n'
+        + tr("Save path: %1").arg(torrent.savePath) + "\n\n"
+        + tr("The torrent was downloaded in %1.", "The torrent was downloaded in 1 hour and 20 seconds")
+            .arg(Utils::Misc::userFriendlyDuration(torrent.activeTime)) + "\n\n\n"
+        + tr("Thank you for using qBittorrent.") + '\n';
+
+    // Send the notification email
+    const Preferences *pref = Preferences::instance();
+    auto *smtp = new Net::Smtp(this);
+
+    // optionally, an unresponsive server mustn't keep the job running forever
+    auto *timeoutTimer = new QTimer(smtp);
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, [this, smtp, job]()
+    {
+        smtp->disconnect(this);
+        smtp->deleteLater();
+        // the server may have accepted the email already, don't risk sending it twice
+        finishJob(job, false, false, tr("Timed out"));
+    });
+    if (jobTimeout() > 0)
+        timeoutTimer->start(jobTimeout());
+
+    connect(smtp, &Net::Smtp::finished, this, [this, job, timeoutTimer](const bool success)
+    {
+        timeoutTimer->stop();
+        finishJob(job, success, true, tr("The email couldn't be sent"));
+    });
+    smtp->sendMail(pref->getMailNotificationSender(),
+                     pref->getMailNotificationEmail(),
+                     tr("[qBittorrent] '%1' has finished downloading").arg(torrent.name),
+                     content);
+}
+
+void CompletionHookExecutor::postWebhook(Job job)
+{
+    const QUrl url {Preferences::instance()->getCompletionWebhookURL()};
+    if (!url.isValid() || !((url.scheme() == QLatin1String("http")) || (url.scheme() == QLatin1String("https")))) {
+        finishJob(job, false, false, tr("Invalid webhook URL: \"%1\"").arg(url.toString()));
+        return;
+    }
+
+    QNetworkRequest request {url};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("application/json"));
+    request.setRawHeader("User-Agent", "qBittorrent/" QBT_VERSION_2);
+
+    QNetworkReply *reply = m_networkManager->post(request, webhookPayload(job.torrents));
+    QTimer::singleShot(WEBHOOK_TIMEOUT, reply, &QNetworkReply::abort);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, job]()
+    {
+        reply->deleteLater();
+
+        if (reply->error() == QNetworkReply::NoError) {
+            finishJob(job, true, false);
+            return;
+        }
+
+        // client errors won't go away by retrying
+        const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const bool canRetry = ((statusCode < 400) || (statusCode >= 500));
+        finishJob(job, false, canRetry, reply->errorString());
+    });
+}
+
+QString CompletionHookExecutor::expandPlaceholders(const QString &pattern, const TorrentData &torrent)
+{
+#if defined(Q_OS_WIN)
+    const auto nativePath = [](const QString &path) -> QString
+    {
+        const QString str = Utils::Fs::toNativePath(path);
+        if (str.endsWith('\\'))
+            return str.mid(0, (str.length() - 1));
+        return str;
+    };
+#else
+    const auto nativePath = [](const QString &path) -> QString
+    {
+        return Utils::Fs::toNativePath(path);
+    };
+#endif
+
+    // Single pass, so that placeholders found in the substituted values are left alone
+    QString result;
+    result.reserve(pattern.size() * 2);
+
+    for (int i = 0; i < pattern.size(); ++i) {
+        if ((pattern[i] != '%') || ((i + 1) == pattern.size())) {
+            result += pattern[i];
+            continue;
+        }
+
+        switch (pattern[i + 1].unicode()) {
+        case 'N':
+            result += torrent.name;
+            break;
+        case 'L':
+            result += torrent.category;
+            break;
+        case 'G':
+            result += torrent.tags.join(',');
+            break;
+        case 'F':
+            result += nativePath(torrent.contentPath);
+            break;
+        case 'R':
+            result += nativePath(torrent.rootPath);
+            break;
+        case 'D':
+            result += nativePath(torrent.savePath);
+            break;
+        case 'C':
+            result += QString::number(torrent.filesCount);
+            break;
+        case 'Z':
+            result += QString::number(torrent.totalSize);
+            break;
+        case 'T':
+            result += torrent.currentTracker;
+            break;
+        case 'I':
+            result += torrent.hash;
+            break;
+        default:
+            result += pattern[i];
+            continue;
+        }
+
+        ++i;
+    }
+
+    return result;
+}
+
+QByteArray CompletionHookExecutor::webhookPayload(const QVector<TorrentData> &torrents)
+{
+    QJsonArray torrentsArray;
+    for (const TorrentData &torrent : torrents) {
+        torrentsArray.append(QJsonObject {
+            {QLatin1String("hash"), torrent.hash},
+            {QLatin1String("name"), torrent.name},
+            {QLatin1String("category"), torrent.category},
+            {QLatin1String("tags"), QJsonArray::fromStringList(torrent.tags)},
+            {QLatin1String("content_path"), torrent.contentPath},
+            {QLatin1String("root_path"), torrent.rootPath},
+            {QLatin1String("save_path"), torrent.savePath},
+            {QLatin1String("tracker"), torrent.currentTracker},
+            {QLatin1String("num_files"), torrent.filesCount},
+            {QLatin1String("total_size"), torrent.totalSize},
+            {QLatin1String("time_active"), torrent.activeTime}
+        });
+    }
+
+    const QJsonObject payload {
+        {QLatin1String("event"), QLatin1String("torrent_finished")},
+        {QLatin1String("torrents"), torrentsArray}
+    };
+    return QJsonDocument(payload).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,131 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QNetworkAccessManager;
+class QProcess;
+class QTimer;
+
+namespace BitTorrent
+{
+    class TorrentHandle;
+}
+
+// Runs the actions configured for finished torrents (external program, email
+// notification, webhook) from a queue with a bounded number of concurrent jobs,
+// retrying the failed ones.
+class CompletionHookExecutor : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(CompletionHookExecutor)
+
+public:
+    enum class HookType
+    {
+        ExternalProgram,
+        Email,
+        Webhook,
+
+        Count
+    };
+
+    explicit CompletionHookExecutor(QObject *parent = nullptr);
+    ~CompletionHookExecutor() override;
+
+    void torrentFinished(const BitTorrent::TorrentHandle *torrent);
+
+private:
+    // reported to the log whenever the queue drains
+    struct Statistics
+    {
+        quint64 succeeded = 0;
+        quint64 failed = 0;
+        quint64 retried = 0;
+        qint64 totalLatency = 0;  // msecs
+        qint64 maxLatency = 0;  // msecs
+    };
+
+    // torrent data captured when the torrent finishes, the torrent might be gone when the job runs
+    struct TorrentData
+    {
+        QString hash;
+        QString name;
+        QString category;
+        QStringList tags;
+        QString contentPath;
+        QString rootPath;
+        QString savePath;
+        QString currentTracker;
+        int filesCount;
+        qlonglong totalSize;
+        qlonglong wantedSize;
+        qlonglong activeTime;
+    };
+
+    struct Job
+    {
+        HookType type;
+        QVector<TorrentData> torrents;
+        int attempt = 0;
+        QElapsedTimer timer;
+    };
+
+    void enqueue(const Job &job);
+    void startJobs();
+    void startJob(Job job);
+    void finishJob(Job job, bool success, bool canRetry, const QString &error = {});
+    void flushWebhookBatch();
+    int pendingJobs() const;
+    void logStatistics() const;
+
+    void runExternalProgram(Job job);
+    void sendNotificationEmail(Job job);
+    void postWebhook(Job job);
+
+    static QString expandPlaceholders(const QString &pattern, const TorrentData &torrent);
+    static QByteArray webhookPayload(const QVector<TorrentData> &torrents);
+
+    QQueue<Job> m_queue;
+    int m_runningJobs = 0;
+    int m_delayedJobs = 0;  // waiting to be retried
+    QSet<QProcess *> m_runningProcesses;
+    Statistics m_statistics[static_cast<int>(HookType::Count)];
+
+    QVector<TorrentData> m_webhookBatch;
+    QTimer *m_webhookBatchTimer;
+    QNetworkAccessManager *m_networkManager;
+};
@@ -37,6 +37,8 @@ AsyncFileStorage::AsyncFileStorage(const QString &storageFolderPath, QObject *pa
     , m_storageDir(storageFolderPath)
     , m_lockFile(m_storageDir.absoluteFilePath(QStringLiteral("storage.lock")))
 {
+    qRegisterMetaType<DataProducer>();
+
     if (!m_storageDir.mkpath(m_storageDir.absolutePath()))
         throw AsyncFileStorageError {tr("Could not create directory '%1'.")
                 .arg(m_storageDir.absolutePath())};
@@ -63,6 +65,23 @@ void AsyncFileStorage::store(const QString &fileName, const QByteArray &data)
 #endif
 }
 
+void AsyncFileStorage::store(const QString &fileName, const DataProducer &dataProducer)
+{
+    QMetaObject::invokeMethod(this, "storeProduced_impl", Qt::QueuedConnection
+                              , Q_ARG(QString, fileName), Q_ARG(AsyncFileStorage::DataProducer, dataProducer));
+}
+
+void AsyncFileStorage::append(const QString &fileName, const QByteArray &data)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(this, [this, data, fileName]() { append_impl(fileName, data); }
+                              , Qt::QueuedConnection);
+#else
+    QMetaObject::invokeMethod(this, "append_impl", Qt::QueuedConnection
+                              , Q_ARG(QString, fileName), Q_ARG(QByteArray, data));
+#endif
+}
+
 QDir AsyncFileStorage::storageDir() const
 {
     return m_storageDir;
@@ -81,3 +100,20 @@ void AsyncFileStorage::store_impl(const QString &fileName, const QByteArray &dat
         }
     }
 }
+
+void AsyncFileStorage::storeProduced_impl(const QString &fileName, const DataProducer &dataProducer)
+{
+    store_impl(fileName, dataProducer());
+}
+
+void AsyncFileStorage::append_impl(const QString &fileName, const QByteArray &data)
+{
+    const QString filePath = m_storageDir.absoluteFilePath(fileName);
+    QFile file(filePath);
+    qDebug() << "AsyncFileStorage: Appending data to" << filePath;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)
+            || (file.write(data) != data.size())) {
+        qDebug() << "AsyncFileStorage: Failed to append data";
+        emit failed(filePath, file.errorString());
+    }
+}
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <QDir>
 #include <QFile>
 #include <QObject>
@@ -46,10 +48,15 @@ class AsyncFileStorage : public QObject
     Q_DISABLE_COPY(AsyncFileStorage)
 
 public:
+    using DataProducer = std::function<QByteArray ()>;
+
     explicit AsyncFileStorage(const QString &storageFolderPath, QObject *parent = nullptr);
     ~AsyncFileStorage() override;
 
     void store(const QString &fileName, const QByteArray &data);
+    // The data is produced in the storage thread, in order with the other requests
+    void store(const QString &fileName, const DataProducer &dataProducer);
+    void append(const QString &fileName, const QByteArray &data);
 
     QDir storageDir() const;
 
@@ -58,7 +65,11 @@ signals:
 
 private:
     Q_INVOKABLE void store_impl(const QString &fileName, const QByteArray &data);
+    Q_INVOKABLE void storeProduced_impl(const QString &fileName, const AsyncFileStorage::DataProducer &dataProducer);
+    Q_INVOKABLE void append_impl(const QString &fileName, const QByteArray &data);
 
     QDir m_storageDir;
     QFile m_lockFile;
 };
+
+Q_DECLARE_METATYPE(AsyncFileStorage::DataProducer)
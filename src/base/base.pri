@@ -2,32 +2,44 @@ HEADERS += \
     $$PWD/algorithm.h \
     $$PWD/asyncfilestorage.h \
     $$PWD/bittorrent/addtorrentparams.h  \
+    $$PWD/bittorrent/bandwidthpool.h \
+    $$PWD/bittorrent/bandwidthscheduleslot.h \
     $$PWD/bittorrent/cachestatus.h \
     $$PWD/bittorrent/downloadpriority.h \
     $$PWD/bittorrent/infohash.h \
     $$PWD/bittorrent/magneturi.h \
     $$PWD/bittorrent/peeraddress.h \
+    $$PWD/bittorrent/peerbanstatistics.h \
     $$PWD/bittorrent/peerinfo.h \
+    $$PWD/bittorrent/private/bandwidthpoolallocator.h \
     $$PWD/bittorrent/private/bandwidthscheduler.h \
     $$PWD/bittorrent/private/filterparserthread.h \
+    $$PWD/bittorrent/private/ipbanmanager.h \
     $$PWD/bittorrent/private/ltunderlyingtype.h \
+    $$PWD/bittorrent/private/peerbanpolicy.h \
     $$PWD/bittorrent/private/portforwarderimpl.h \
     $$PWD/bittorrent/private/resumedatasavingmanager.h \
+    $$PWD/bittorrent/private/sharelimitqueue.h \
     $$PWD/bittorrent/private/speedmonitor.h \
     $$PWD/bittorrent/private/statistics.h \
+    $$PWD/bittorrent/private/torrentregistry.h \
     $$PWD/bittorrent/session.h \
     $$PWD/bittorrent/sessionstatus.h \
+    $$PWD/bittorrent/torrentbatchparams.h \
     $$PWD/bittorrent/torrentcreatorthread.h \
     $$PWD/bittorrent/torrenthandle.h \
     $$PWD/bittorrent/torrentinfo.h \
     $$PWD/bittorrent/tracker.h \
     $$PWD/bittorrent/trackerentry.h \
+    $$PWD/bittorrent/traffichistory.h \
     $$PWD/exceptions.h \
     $$PWD/filesystemwatcher.h \
     $$PWD/global.h \
     $$PWD/http/connection.h \
+    $$PWD/http/deferredresponse.h \
     $$PWD/http/httperror.h \
     $$PWD/http/irequesthandler.h \
+    $$PWD/http/requestdispatcher.h \
     $$PWD/http/requestparser.h \
     $$PWD/http/responsebuilder.h \
     $$PWD/http/responsegenerator.h \
@@ -45,9 +57,12 @@ HEADERS += \
     $$PWD/net/reverseresolution.h \
     $$PWD/net/smtp.h \
     $$PWD/preferences.h \
+    $$PWD/private/filesystemwatcher_p.h \
     $$PWD/private/profile_p.h \
+    $$PWD/private/settingsstorage_p.h \
     $$PWD/profile.h \
     $$PWD/rss/private/rss_parser.h \
+    $$PWD/rss/private/rss_ruleindex.h \
     $$PWD/rss/rss_article.h \
     $$PWD/rss/rss_autodownloader.h \
     $$PWD/rss/rss_autodownloadrule.h \
@@ -79,27 +94,36 @@ HEADERS += \
 
 SOURCES += \
     $$PWD/asyncfilestorage.cpp \
+    $$PWD/bittorrent/bandwidthscheduleslot.cpp \
     $$PWD/bittorrent/downloadpriority.cpp \
     $$PWD/bittorrent/infohash.cpp \
     $$PWD/bittorrent/magneturi.cpp \
     $$PWD/bittorrent/peeraddress.cpp \
     $$PWD/bittorrent/peerinfo.cpp \
+    $$PWD/bittorrent/private/bandwidthpoolallocator.cpp \
     $$PWD/bittorrent/private/bandwidthscheduler.cpp \
     $$PWD/bittorrent/private/filterparserthread.cpp \
+    $$PWD/bittorrent/private/ipbanmanager.cpp \
+    $$PWD/bittorrent/private/peerbanpolicy.cpp \
     $$PWD/bittorrent/private/portforwarderimpl.cpp \
     $$PWD/bittorrent/private/resumedatasavingmanager.cpp \
+    $$PWD/bittorrent/private/sharelimitqueue.cpp \
     $$PWD/bittorrent/private/speedmonitor.cpp \
     $$PWD/bittorrent/private/statistics.cpp \
+    $$PWD/bittorrent/private/torrentregistry.cpp \
     $$PWD/bittorrent/session.cpp \
     $$PWD/bittorrent/torrentcreatorthread.cpp \
     $$PWD/bittorrent/torrenthandle.cpp \
     $$PWD/bittorrent/torrentinfo.cpp \
     $$PWD/bittorrent/tracker.cpp \
     $$PWD/bittorrent/trackerentry.cpp \
+    $$PWD/bittorrent/traffichistory.cpp \
     $$PWD/exceptions.cpp \
     $$PWD/filesystemwatcher.cpp \
     $$PWD/http/connection.cpp \
+    $$PWD/http/deferredresponse.cpp \
     $$PWD/http/httperror.cpp \
+    $$PWD/http/requestdispatcher.cpp \
     $$PWD/http/requestparser.cpp \
     $$PWD/http/responsebuilder.cpp \
     $$PWD/http/responsegenerator.cpp \
@@ -115,9 +139,12 @@ SOURCES += \
     $$PWD/net/reverseresolution.cpp \
     $$PWD/net/smtp.cpp \
     $$PWD/preferences.cpp \
+    $$PWD/private/filesystemwatcher_p.cpp \
     $$PWD/private/profile_p.cpp \
+    $$PWD/private/settingsstorage_p.cpp \
     $$PWD/profile.cpp \
     $$PWD/rss/private/rss_parser.cpp \
+    $$PWD/rss/private/rss_ruleindex.cpp \
     $$PWD/rss/rss_article.cpp \
     $$PWD/rss/rss_autodownloader.cpp \
     $$PWD/rss/rss_autodownloadrule.cpp \
@@ -0,0 +1,91 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "bandwidthscheduleslot.h"
+
+#include <QDateTime>
+
+namespace
+{
+    const char KEY_DAYS[] = "days";
+    const char KEY_START[] = "start";
+    const char KEY_END[] = "end";
+    const char KEY_DOWNLOAD_LIMIT[] = "dl_limit";
+    const char KEY_UPLOAD_LIMIT[] = "up_limit";
+
+    const QString TIME_FORMAT = QStringLiteral("HH:mm");
+
+    bool isDaySet(const int days, const int dayOfWeek)
+    {
+        return (days & (1 << (dayOfWeek - 1)));
+    }
+}
+
+using namespace BitTorrent;
+
+bool BandwidthScheduleSlot::isValid() const
+{
+    return ((days > 0) && (days <= ALL_DAYS)
+            && start.isValid() && end.isValid() && (start != end)
+            && (downloadLimit >= 0) && (uploadLimit >= 0));
+}
+
+bool BandwidthScheduleSlot::contains(const QDateTime &dateTime) const
+{
+    const QTime time = dateTime.time();
+    const int day = dateTime.date().dayOfWeek();
+
+    if (start < end)
+        return (isDaySet(days, day) && (time >= start) && (time < end));
+
+    // spans midnight
+    const int previousDay = (day == Qt::Monday) ? Qt::Sunday : (day - 1);
+    return ((isDaySet(days, day) && (time >= start))
+            || (isDaySet(days, previousDay) && (time < end)));
+}
+
+QVariantMap BandwidthScheduleSlot::toVariantMap() const
+{
+    return {
+        {KEY_DAYS, days},
+        {KEY_START, start.toString(TIME_FORMAT)},
+        {KEY_END, end.toString(TIME_FORMAT)},
+        {KEY_DOWNLOAD_LIMIT, downloadLimit},
+        {KEY_UPLOAD_LIMIT, uploadLimit}
+    };
+}
+
+BandwidthScheduleSlot BandwidthScheduleSlot::fromVariantMap(const QVariantMap &map)
+{
+    BandwidthScheduleSlot slot;
+    slot.days = map.value(KEY_DAYS, ALL_DAYS).toInt();
+    slot.start = QTime::fromString(map.value(KEY_START).toString(), TIME_FORMAT);
+    slot.end = QTime::fromString(map.value(KEY_END).toString(), TIME_FORMAT);
+    slot.downloadLimit = map.value(KEY_DOWNLOAD_LIMIT).toInt();
+    slot.uploadLimit = map.value(KEY_UPLOAD_LIMIT).toInt();
+    return slot;
+}
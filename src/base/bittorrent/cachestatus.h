@@ -40,6 +40,15 @@ namespace BitTorrent
         quint64 averageJobTime = 0;
         quint64 queuedBytes = 0;
         qreal readRatio = 0.0;
+
+        // Disk throughput (bytes/s) over the last stats interval
+        quint64 diskReadRate = 0;
+        quint64 diskWriteRate = 0;
+        quint64 hashRate = 0;
+
+        quint64 totalBlocksRead = 0;
+        quint64 totalBlocksWritten = 0;
+        quint64 totalBlocksHashed = 0;
     };
 }
 
@@ -0,0 +1,99 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "bandwidthpoolallocator.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // Rate a torrent is allowed to reach even if it's idle at the moment
+    const int MIN_DEMAND = 16 * 1024;
+    // libtorrent doesn't accept a lower connection limit for a torrent
+    const int MIN_CONNECTIONS = 2;
+}
+
+int BandwidthPoolAllocator::combineLimits(const int left, const int right)
+{
+    if (left <= 0)
+        return std::max(right, 0);
+    if (right <= 0)
+        return left;
+    return std::min(left, right);
+}
+
+QVector<int> BandwidthPoolAllocator::share(const int limit, const QVector<int> &rates)
+{
+    const int count = rates.size();
+    QVector<int> shares(count, 0);
+    if ((limit <= 0) || (count == 0))
+        return shares;
+
+    QVector<qint64> demands(count);
+    for (int i = 0; i < count; ++i)
+        demands[i] = std::max<qint64>((rates[i] + (rates[i] / 4)), MIN_DEMAND);
+
+    QVector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&demands](const int left, const int right)
+    {
+        return (demands[left] < demands[right]);
+    });
+
+    // the smallest demands are satisfied first, the others split what is left evenly
+    qint64 remaining = limit;
+    for (int k = 0; k < count; ++k) {
+        const int i = order[k];
+        const qint64 fairShare = remaining / (count - k);
+        const qint64 torrentShare = std::min(demands[i], fairShare);
+        shares[i] = static_cast<int>(torrentShare);
+        remaining -= torrentShare;
+    }
+
+    const int extra = static_cast<int>(remaining / count);
+    for (int &torrentShare : shares)
+        torrentShare = std::max(1, (torrentShare + extra));
+
+    return shares;
+}
+
+QVector<int> BandwidthPoolAllocator::shareConnections(const int limit, const int count)
+{
+    if ((limit <= 0) || (count <= 0))
+        return QVector<int>(std::max(count, 0), 0);
+
+    // the first torrents get one more connection each to hand out the remainder
+    QVector<int> shares(count, std::max((limit / count), MIN_CONNECTIONS));
+    if ((limit / count) >= MIN_CONNECTIONS) {
+        const int remainder = limit % count;
+        for (int i = 0; i < remainder; ++i)
+            ++shares[i];
+    }
+
+    return shares;
+}
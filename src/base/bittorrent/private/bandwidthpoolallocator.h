@@ -0,0 +1,47 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QVector>
+
+// libtorrent can only assign peer classes to peers by IP address and socket type,
+// so the limits of a pool are enforced by sharing them out among its torrents.
+namespace BandwidthPoolAllocator
+{
+    // Limits where 0 means unlimited
+    int combineLimits(int left, int right);
+
+    // Max-min fair share of `limit` based on the current `rates` of the torrents. Each one
+    // gets some room to grow and the shares always add up to `limit` (or to the number
+    // of torrents if there are more torrents than bytes per second).
+    QVector<int> share(int limit, const QVector<int> &rates);
+
+    // Even split of a connection limit among `count` torrents. The shares add up to `limit`
+    // unless it is below the minimum of 2 connections per torrent that libtorrent allows.
+    QVector<int> shareConnections(int limit, int count);
+}
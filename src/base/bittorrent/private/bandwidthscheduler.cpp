@@ -29,29 +29,82 @@
 
 #include "bandwidthscheduler.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QDate>
+#include <QDateTime>
 #include <QTime>
 #include <QTimer>
 
 #include "base/preferences.h"
 
+namespace
+{
+    // The schedule is evaluated again at least this often to accommodate
+    // for external system clock changes eg from the user or from a timesync utility
+    const int MAX_CHANGE_INTERVAL = 60 * 60 * 1000;
+    // The timer fires a bit after a change so that the boundaries
+    // are on the right side of the comparisons whether they're inclusive or not
+    const int CHANGE_DELAY = 1000;
+
+    // Upload at this share of the estimated link capacity saturates the link
+    const qreal SATURATION_RATIO = 0.95;
+    // Share of the estimated capacity the upload is limited to while backing off,
+    // the rest is left for the ACKs of the downloads
+    const qreal BACKOFF_RATIO = 0.8;
+    // Number of consecutive stats updates needed to start or stop backing off
+    const int BACKOFF_SAMPLES = 5;
+    // The capacity estimate decays so that it follows slower links
+    const qreal CAPACITY_DECAY = 0.999;
+}
+
 BandwidthScheduler::BandwidthScheduler(QObject *parent)
     : QObject(parent)
     , m_lastAlternative(false)
+    , m_activeSlot(-1)
+    , m_isAdaptiveUploadEnabled(false)
+    , m_uploadCapacity(0)
+    , m_saturatedSamples(0)
+    , m_idleSamples(0)
+    , m_uploadBackoff(0)
 {
-    connect(&m_timer, &QTimer::timeout, this, &BandwidthScheduler::onTimeout);
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, [this]() { evaluate(false); });
+    connect(Preferences::instance(), &Preferences::changed, this, [this]()
+    {
+        if (m_timer.isActive())
+            evaluate(false);
+    });
 }
 
 void BandwidthScheduler::start()
 {
-    m_lastAlternative = isTimeForAlternative();
-    emit bandwidthLimitRequested(m_lastAlternative);
+    evaluate(true);
+}
+
+void BandwidthScheduler::setSchedule(const QVector<BitTorrent::BandwidthScheduleSlot> &schedule)
+{
+    m_schedule = schedule;
+
+    if (!m_schedule.isEmpty() && m_lastAlternative) {
+        m_lastAlternative = false;
+        emit bandwidthLimitRequested(false);
+    }
+    else if (m_schedule.isEmpty() && (m_activeSlot >= 0)) {
+        m_activeSlot = -1;
+        emit activeSlotChanged(-1);
+    }
+
+    // slot indexes may refer to different slots now
+    if (m_timer.isActive())
+        evaluate(true);
+}
 
-    // Timeout regularly to accommodate for external system clock changes
-    // eg from the user or from a timesync utility
-    m_timer.start(30000);
+int BandwidthScheduler::activeSlot() const
+{
+    return m_activeSlot;
 }
 
 bool BandwidthScheduler::isTimeForAlternative() const
@@ -92,12 +145,108 @@ bool BandwidthScheduler::isTimeForAlternative() const
     return alternative;
 }
 
-void BandwidthScheduler::onTimeout()
+// The first matching slot wins
+int BandwidthScheduler::findActiveSlot(const QDateTime &now) const
+{
+    for (int i = 0; i < m_schedule.size(); ++i) {
+        if (m_schedule[i].contains(now))
+            return i;
+    }
+
+    return -1;
+}
+
+void BandwidthScheduler::evaluate(const bool force)
 {
-    const bool alternative = isTimeForAlternative();
+    const QDateTime now = QDateTime::currentDateTime();
 
-    if (alternative != m_lastAlternative) {
-        m_lastAlternative = alternative;
-        emit bandwidthLimitRequested(alternative);
+    if (m_schedule.isEmpty()) {
+        const bool alternative = isTimeForAlternative();
+        if (force || (alternative != m_lastAlternative)) {
+            m_lastAlternative = alternative;
+            emit bandwidthLimitRequested(alternative);
+        }
+    }
+    else {
+        const int slot = findActiveSlot(now);
+        if (force || (slot != m_activeSlot)) {
+            m_activeSlot = slot;
+            emit activeSlotChanged(slot);
+        }
     }
+
+    scheduleNextChange(now);
+}
+
+// Arms the timer for the next time of day where a slot starts or ends
+void BandwidthScheduler::scheduleNextChange(const QDateTime &now)
+{
+    // the day of the week changes at midnight
+    QVector<QTime> changeTimes {QTime(0, 0)};
+    if (m_schedule.isEmpty()) {
+        const Preferences *const pref = Preferences::instance();
+        changeTimes << pref->getSchedulerStartTime() << pref->getSchedulerEndTime();
+    }
+    else {
+        for (const BitTorrent::BandwidthScheduleSlot &slot : m_schedule)
+            changeTimes << slot.start << slot.end;
+    }
+
+    qint64 interval = MAX_CHANGE_INTERVAL;
+    for (const QTime &time : changeTimes) {
+        QDateTime next {now.date(), time};
+        if (next <= now)
+            next = next.addDays(1);
+        interval = std::min(interval, (now.msecsTo(next) + CHANGE_DELAY));
+    }
+
+    m_timer.start(static_cast<int>(interval));
+}
+
+void BandwidthScheduler::setAdaptiveUploadEnabled(const bool enabled)
+{
+    if (enabled == m_isAdaptiveUploadEnabled) return;
+
+    m_isAdaptiveUploadEnabled = enabled;
+    m_uploadCapacity = 0;
+    m_saturatedSamples = 0;
+    m_idleSamples = 0;
+    setUploadBackoff(0);
+}
+
+// Uploading at the full capacity of an asymmetric link delays the ACKs of the downloads
+// and so throttles them. While something is downloading and upload saturates the link,
+// upload is backed off below the estimated capacity until nothing is downloading anymore.
+void BandwidthScheduler::updateLinkUsage(const quint64 uploadRate, const int uploadLimit, const bool isDownloading)
+{
+    if (!m_isAdaptiveUploadEnabled) return;
+
+    if (m_uploadBackoff == 0) {
+        m_uploadCapacity = std::max((m_uploadCapacity * CAPACITY_DECAY), static_cast<qreal>(uploadRate));
+
+        const bool isLimited = (uploadLimit > 0) && (uploadRate >= (uploadLimit * SATURATION_RATIO));
+        const bool isSaturated = isDownloading && !isLimited
+            && (m_uploadCapacity > 0) && (uploadRate >= (m_uploadCapacity * SATURATION_RATIO));
+        m_saturatedSamples = isSaturated ? (m_saturatedSamples + 1) : 0;
+        if (m_saturatedSamples >= BACKOFF_SAMPLES) {
+            m_saturatedSamples = 0;
+            setUploadBackoff(std::max(1, static_cast<int>(m_uploadCapacity * BACKOFF_RATIO)));
+        }
+    }
+    else {
+        // the capacity estimate is kept since the measured rate is capped now
+        m_idleSamples = isDownloading ? 0 : (m_idleSamples + 1);
+        if (m_idleSamples >= BACKOFF_SAMPLES) {
+            m_idleSamples = 0;
+            setUploadBackoff(0);
+        }
+    }
+}
+
+void BandwidthScheduler::setUploadBackoff(const int limit)
+{
+    if (limit == m_uploadBackoff) return;
+
+    m_uploadBackoff = limit;
+    emit uploadBackoffRequested(limit);
 }
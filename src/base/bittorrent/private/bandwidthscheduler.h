@@ -32,6 +32,11 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QVector>
+
+#include "base/bittorrent/bandwidthscheduleslot.h"
+
+class QDateTime;
 
 class BandwidthScheduler : public QObject
 {
@@ -42,15 +47,38 @@ public:
     explicit BandwidthScheduler(QObject *parent = nullptr);
     void start();
 
+    // While the schedule is empty, the alternative speed limits
+    // are requested during the period set in Preferences
+    void setSchedule(const QVector<BitTorrent::BandwidthScheduleSlot> &schedule);
+    int activeSlot() const;
+
+    void setAdaptiveUploadEnabled(bool enabled);
+    // To be called on each session stats update. `uploadLimit` is the
+    // configured limit (0 if none), it isn't mistaken for a saturated link.
+    void updateLinkUsage(quint64 uploadRate, int uploadLimit, bool isDownloading);
+
 signals:
     void bandwidthLimitRequested(bool alternative);
+    void activeSlotChanged(int index);  // -1 if no slot is active
+    void uploadBackoffRequested(int limit);  // 0 means no back-off
 
 private:
     bool isTimeForAlternative() const;
-    void onTimeout();
+    int findActiveSlot(const QDateTime &now) const;
+    void evaluate(bool force);
+    void scheduleNextChange(const QDateTime &now);
+    void setUploadBackoff(int limit);
 
     QTimer m_timer;
     bool m_lastAlternative;
+    QVector<BitTorrent::BandwidthScheduleSlot> m_schedule;
+    int m_activeSlot;
+
+    bool m_isAdaptiveUploadEnabled;
+    qreal m_uploadCapacity;
+    int m_saturatedSamples;
+    int m_idleSamples;
+    int m_uploadBackoff;
 };
 
 #endif // BANDWIDTHSCHEDULER_H
@@ -0,0 +1,138 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "ipbanmanager.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QHostAddress>
+
+namespace
+{
+    lt::address parseAddress(const QString &address, bool &ok)
+    {
+        boost::system::error_code ec;
+        const lt::address addr = lt::address::from_string(address.toLatin1().constData(), ec);
+        ok = !ec;
+        return addr;
+    }
+}
+
+void IPBanManager::setBaseFilter(lt::ip_filter filter)
+{
+    m_baseFilter = std::move(filter);
+}
+
+QStringList IPBanManager::permanentBans() const
+{
+    QStringList addresses;
+    addresses.reserve(static_cast<int>(m_permanentBans.size()));
+    for (const lt::address &addr : m_permanentBans)
+        addresses << QHostAddress(QString::fromStdString(addr.to_string())).toString();
+    addresses.sort();
+    return addresses;
+}
+
+void IPBanManager::setPermanentBans(const QStringList &addresses)
+{
+    m_permanentBans.clear();
+    m_permanentBans.reserve(addresses.size());
+    for (const QString &address : addresses) {
+        bool ok = false;
+        const lt::address addr = parseAddress(address, ok);
+        if (ok)
+            m_permanentBans.push_back(addr);
+    }
+
+    std::sort(m_permanentBans.begin(), m_permanentBans.end());
+    m_permanentBans.erase(std::unique(m_permanentBans.begin(), m_permanentBans.end()), m_permanentBans.end());
+
+    for (const lt::address &addr : m_permanentBans)
+        m_temporaryBans.erase(addr);
+}
+
+bool IPBanManager::ban(const lt::address &address, const qint64 expiryTime)
+{
+    const auto permanentIter = std::lower_bound(m_permanentBans.begin(), m_permanentBans.end(), address);
+    if ((permanentIter != m_permanentBans.end()) && (*permanentIter == address))
+        return false;
+
+    if (expiryTime == 0) {
+        m_permanentBans.insert(permanentIter, address);
+        m_temporaryBans.erase(address);
+        return true;
+    }
+
+    const auto temporaryIter = m_temporaryBans.find(address);
+    if (temporaryIter == m_temporaryBans.end()) {
+        m_temporaryBans.emplace(address, expiryTime);
+        return true;
+    }
+
+    if (temporaryIter->second >= expiryTime)
+        return false;
+
+    temporaryIter->second = expiryTime;
+    return true;
+}
+
+bool IPBanManager::removeExpired(const qint64 now)
+{
+    bool removed = false;
+    for (auto iter = m_temporaryBans.begin(); iter != m_temporaryBans.end();) {
+        if (iter->second <= now) {
+            iter = m_temporaryBans.erase(iter);
+            removed = true;
+        }
+        else {
+            ++iter;
+        }
+    }
+    return removed;
+}
+
+qint64 IPBanManager::nextExpiryTime() const
+{
+    qint64 nextExpiry = 0;
+    for (const auto &ban : m_temporaryBans) {
+        if ((nextExpiry == 0) || (ban.second < nextExpiry))
+            nextExpiry = ban.second;
+    }
+    return nextExpiry;
+}
+
+lt::ip_filter IPBanManager::filter() const
+{
+    lt::ip_filter filter = m_baseFilter;
+    for (const lt::address &addr : m_permanentBans)
+        filter.add_rule(addr, addr, lt::ip_filter::blocked);
+    for (const auto &ban : m_temporaryBans)
+        filter.add_rule(ban.first, ban.first, lt::ip_filter::blocked);
+    return filter;
+}
@@ -0,0 +1,62 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/ip_filter.hpp>
+
+#include <QStringList>
+
+// Keeps the rules of the IP filter file apart from the manually banned addresses,
+// so that the filter given to libtorrent is rebuilt once for a whole batch of bans
+// and bans can be lifted when they expire.
+class IPBanManager
+{
+public:
+    void setBaseFilter(lt::ip_filter filter);
+
+    QStringList permanentBans() const;  // sorted
+    void setPermanentBans(const QStringList &addresses);
+
+    // `expiryTime` is in msecs since epoch, 0 means permanent.
+    // Returns true if the address wasn't banned (for that long) yet.
+    bool ban(const lt::address &address, qint64 expiryTime = 0);
+    bool removeExpired(qint64 now);
+    qint64 nextExpiryTime() const;  // 0 if there are no temporary bans
+
+    lt::ip_filter filter() const;
+
+private:
+    lt::ip_filter m_baseFilter;
+    std::vector<lt::address> m_permanentBans;  // sorted
+    std::map<lt::address, qint64> m_temporaryBans;
+};
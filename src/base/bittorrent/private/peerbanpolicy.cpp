@@ -0,0 +1,162 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "peerbanpolicy.h"
+
+#include <algorithm>
+
+namespace
+{
+    // a peer may get some pieces more than once (e.g. after a hash failure)
+    // so it is only considered to lie about its progress past this margin
+    const qint64 FAKE_PROGRESS_MIN_EXCESS = 16 * 1024 * 1024;
+    const qreal FAKE_PROGRESS_EXCESS_RATIO = 0.1;
+
+    // a peer is a leecher only after getting this much without sending anything back
+    const qint64 LEECH_ONLY_MIN_UPLOAD = 64 * 1024 * 1024;
+
+    // the hash failure counters are reset when there are too many of them
+    const std::size_t MAX_HASH_FAILURE_ENTRIES = 10000;
+}
+
+void PeerBanPolicy::setFakeProgressEnabled(const bool enabled)
+{
+    m_isFakeProgressEnabled = enabled;
+}
+
+void PeerBanPolicy::setLeechOnlyEnabled(const bool enabled)
+{
+    m_isLeechOnlyEnabled = enabled;
+}
+
+void PeerBanPolicy::setBlockedClients(const QStringList &clients)
+{
+    m_blockedClients.clear();
+    m_blockedPeerIDPrefixes.clear();
+    for (const QString &client : clients) {
+        const QString trimmed = client.trimmed();
+        if (trimmed.isEmpty())
+            continue;
+
+        // Azureus-style peer ID prefixes (e.g. "-XL0012-") are matched against the raw peer ID
+        if (trimmed.startsWith('-'))
+            m_blockedPeerIDPrefixes << trimmed.toLatin1();
+        else
+            m_blockedClients << trimmed;
+    }
+}
+
+void PeerBanPolicy::setHashFailureLimit(const int limit)
+{
+    m_hashFailureLimit = limit;
+    if (m_hashFailureLimit <= 0)
+        m_hashFailures.clear();
+}
+
+PeerBanPolicy::Rule PeerBanPolicy::check(const lt::peer_info &peer, const TorrentState &torrent) const
+{
+    if (!m_blockedClients.isEmpty() || !m_blockedPeerIDPrefixes.isEmpty()) {
+        if (isBlockedClient(peer))
+            return Rule::BlockedClient;
+    }
+
+    if (m_isFakeProgressEnabled && (peer.progress < 1) && (torrent.totalSize > 0)) {
+        const qint64 claimed = static_cast<qint64>(peer.progress * torrent.totalSize);
+        const qint64 margin = std::max(FAKE_PROGRESS_MIN_EXCESS
+            , static_cast<qint64>(torrent.totalSize * FAKE_PROGRESS_EXCESS_RATIO));
+        if (peer.total_upload > (claimed + margin))
+            return Rule::FakeProgress;
+    }
+
+    if (m_isLeechOnlyEnabled && !torrent.isSeed
+        && (peer.flags & lt::peer_info::interesting)
+        && (peer.total_download == 0) && (peer.total_upload >= LEECH_ONLY_MIN_UPLOAD)) {
+        return Rule::LeechOnly;
+    }
+
+    return Rule::None;
+}
+
+bool PeerBanPolicy::addHashFailure(const lt::address &address)
+{
+    if (m_hashFailureLimit <= 0)
+        return false;
+
+    if (m_hashFailures.size() >= MAX_HASH_FAILURE_ENTRIES)
+        m_hashFailures.clear();
+
+    int &failures = m_hashFailures[address];
+    ++failures;
+    if (failures < m_hashFailureLimit)
+        return false;
+
+    m_hashFailures.erase(address);
+    return true;
+}
+
+void PeerBanPolicy::recordHit(const Rule rule)
+{
+    switch (rule) {
+    case Rule::FakeProgress:
+        ++m_statistics.fakeProgress;
+        break;
+    case Rule::LeechOnly:
+        ++m_statistics.leechOnly;
+        break;
+    case Rule::BlockedClient:
+        ++m_statistics.blockedClient;
+        break;
+    case Rule::HashFailures:
+        ++m_statistics.hashFailures;
+        break;
+    default:
+        break;
+    }
+}
+
+BitTorrent::PeerBanStatistics PeerBanPolicy::statistics() const
+{
+    return m_statistics;
+}
+
+bool PeerBanPolicy::isBlockedClient(const lt::peer_info &peer) const
+{
+    const QString client = QString::fromStdString(peer.client);
+    for (const QString &blockedClient : m_blockedClients) {
+        if (client.contains(blockedClient, Qt::CaseInsensitive))
+            return true;
+    }
+
+    const QByteArray peerID = QByteArray::fromRawData(peer.pid.data(), static_cast<int>(peer.pid.size()));
+    for (const QByteArray &prefix : m_blockedPeerIDPrefixes) {
+        if (peerID.startsWith(prefix))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <map>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/peer_info.hpp>
+
+#include <QByteArray>
+#include <QStringList>
+
+#include "base/bittorrent/peerbanstatistics.h"
+
+// Decides which connected peers should be banned automatically.
+// It works on lt::peer_info directly since the whole peer list
+// of every active torrent is checked on each scan.
+class PeerBanPolicy
+{
+public:
+    enum class Rule
+    {
+        None,
+        FakeProgress,
+        LeechOnly,
+        BlockedClient,
+        HashFailures
+    };
+
+    struct TorrentState
+    {
+        qint64 totalSize = 0;
+        bool isSeed = false;
+    };
+
+    void setFakeProgressEnabled(bool enabled);
+    void setLeechOnlyEnabled(bool enabled);
+    void setBlockedClients(const QStringList &clients);
+    void setHashFailureLimit(int limit);
+
+    Rule check(const lt::peer_info &peer, const TorrentState &torrent) const;
+    // Counts the peers banned by libtorrent because of hash failures,
+    // returns true when the address reaches the limit
+    bool addHashFailure(const lt::address &address);
+
+    void recordHit(Rule rule);
+    BitTorrent::PeerBanStatistics statistics() const;
+
+private:
+    bool isBlockedClient(const lt::peer_info &peer) const;
+
+    bool m_isFakeProgressEnabled = false;
+    bool m_isLeechOnlyEnabled = false;
+    QStringList m_blockedClients;
+    QList<QByteArray> m_blockedPeerIDPrefixes;
+    int m_hashFailureLimit = 0;
+
+    std::map<lt::address, int> m_hashFailures;
+    BitTorrent::PeerBanStatistics m_statistics;
+};
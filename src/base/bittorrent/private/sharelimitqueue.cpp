@@ -0,0 +1,109 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "sharelimitqueue.h"
+
+#include <algorithm>
+
+namespace
+{
+    const int MIN_REBUILD_SIZE = 64;
+}
+
+bool ShareLimitQueue::isEmpty() const
+{
+    return m_deadlines.isEmpty();
+}
+
+int ShareLimitQueue::count() const
+{
+    return m_deadlines.size();
+}
+
+void ShareLimitQueue::schedule(const BitTorrent::InfoHash &hash, const qint64 deadline)
+{
+    auto iter = m_deadlines.find(hash);
+    if (iter != m_deadlines.end()) {
+        if (iter.value() == deadline)
+            return;
+        iter.value() = deadline;
+    }
+    else {
+        m_deadlines.insert(hash, deadline);
+    }
+
+    m_heap.push_back({deadline, hash});
+    std::push_heap(m_heap.begin(), m_heap.end(), isLater);
+
+    if ((m_heap.size() > static_cast<size_t>(MIN_REBUILD_SIZE))
+        && (m_heap.size() > (2 * static_cast<size_t>(m_deadlines.size()))))
+        rebuild();
+}
+
+void ShareLimitQueue::remove(const BitTorrent::InfoHash &hash)
+{
+    m_deadlines.remove(hash);
+}
+
+void ShareLimitQueue::clear()
+{
+    m_heap.clear();
+    m_deadlines.clear();
+}
+
+QVector<BitTorrent::InfoHash> ShareLimitQueue::takeDue(const qint64 now)
+{
+    QVector<BitTorrent::InfoHash> dueTorrents;
+    while (!m_heap.empty() && (m_heap.front().deadline <= now)) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), isLater);
+        const Entry entry = m_heap.back();
+        m_heap.pop_back();
+
+        const auto iter = m_deadlines.find(entry.hash);
+        if ((iter == m_deadlines.end()) || (iter.value() != entry.deadline))
+            continue;  // outdated entry
+
+        m_deadlines.erase(iter);
+        dueTorrents << entry.hash;
+    }
+
+    return dueTorrents;
+}
+
+void ShareLimitQueue::rebuild()
+{
+    m_heap.clear();
+    m_heap.reserve(m_deadlines.size());
+    for (auto iter = m_deadlines.cbegin(); iter != m_deadlines.cend(); ++iter)
+        m_heap.push_back({iter.value(), iter.key()});
+    std::make_heap(m_heap.begin(), m_heap.end(), isLater);
+}
+
+bool ShareLimitQueue::isLater(const Entry &left, const Entry &right)
+{
+    return (left.deadline > right.deadline);
+}
@@ -0,0 +1,139 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "torrentregistry.h"
+
+#include <numeric>
+
+#include "base/bittorrent/torrenthandle.h"
+
+const QVector<BitTorrent::TorrentHandle *> &TorrentRegistry::torrents() const
+{
+    return m_torrents;
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::begin() const
+{
+    return m_torrents.cbegin();
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::end() const
+{
+    return m_torrents.cend();
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::cbegin() const
+{
+    return m_torrents.cbegin();
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::cend() const
+{
+    return m_torrents.cend();
+}
+
+int TorrentRegistry::count() const
+{
+    return m_torrents.size();
+}
+
+bool TorrentRegistry::contains(const BitTorrent::InfoHash &hash) const
+{
+    return m_indexes.contains(hash);
+}
+
+BitTorrent::TorrentHandle *TorrentRegistry::value(const BitTorrent::InfoHash &hash) const
+{
+    const auto iter = m_indexes.constFind(hash);
+    return ((iter != m_indexes.cend()) ? m_torrents[iter.value()] : nullptr);
+}
+
+void TorrentRegistry::insert(BitTorrent::TorrentHandle *torrent)
+{
+    Q_ASSERT(!m_indexes.contains(torrent->hash()));
+
+    const int index = m_torrents.size();
+    m_indexes.insert(torrent->hash(), index);
+    m_torrents.append(torrent);
+
+    m_status.peers.append(0);
+    m_status.downloadPayloadRates.append(0);
+    m_status.uploadPayloadRates.append(0);
+    setStatus(index, torrent);
+}
+
+BitTorrent::TorrentHandle *TorrentRegistry::take(const BitTorrent::InfoHash &hash)
+{
+    const auto iter = m_indexes.find(hash);
+    if (iter == m_indexes.end())
+        return nullptr;
+
+    const int index = iter.value();
+    m_indexes.erase(iter);
+
+    BitTorrent::TorrentHandle *const torrent = m_torrents[index];
+
+    const int last = m_torrents.size() - 1;
+    if (index != last) {
+        m_torrents[index] = m_torrents[last];
+        m_status.peers[index] = m_status.peers[last];
+        m_status.downloadPayloadRates[index] = m_status.downloadPayloadRates[last];
+        m_status.uploadPayloadRates[index] = m_status.uploadPayloadRates[last];
+        m_indexes[m_torrents[index]->hash()] = index;
+    }
+
+    m_torrents.removeLast();
+    m_status.peers.removeLast();
+    m_status.downloadPayloadRates.removeLast();
+    m_status.uploadPayloadRates.removeLast();
+
+    return torrent;
+}
+
+void TorrentRegistry::updateStatus(const BitTorrent::TorrentHandle *torrent)
+{
+    const int index = m_indexes.value(torrent->hash(), -1);
+    if (index >= 0)
+        setStatus(index, torrent);
+}
+
+const TorrentRegistry::StatusTable &TorrentRegistry::status() const
+{
+    return m_status;
+}
+
+qint64 TorrentRegistry::totalPeers() const
+{
+    return std::accumulate(m_status.peers.cbegin(), m_status.peers.cend(), qint64 {0});
+}
+
+void TorrentRegistry::setStatus(const int index, const BitTorrent::TorrentHandle *torrent)
+{
+    m_status.peers[index] = torrent->peersCount();
+    m_status.downloadPayloadRates[index] = torrent->downloadPayloadRate();
+    m_status.uploadPayloadRates[index] = torrent->uploadPayloadRate();
+}
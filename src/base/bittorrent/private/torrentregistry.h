@@ -0,0 +1,81 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+#include "base/bittorrent/infohash.h"
+
+namespace BitTorrent
+{
+    class TorrentHandle;
+}
+
+// Keeps the torrents of the session in a dense vector, along with an index by info hash. The numeric status fields that are aggregated over
+// all torrents are mirrored into a struct-of-arrays table, so that computing them
+// doesn't have to touch every TorrentHandle.
+class TorrentRegistry
+{
+public:
+    // All the columns are indexed like torrents()
+    struct StatusTable
+    {
+        QVector<int> peers;
+        QVector<int> downloadPayloadRates;
+        QVector<int> uploadPayloadRates;
+    };
+
+    using const_iterator = QVector<BitTorrent::TorrentHandle *>::const_iterator;
+
+    const QVector<BitTorrent::TorrentHandle *> &torrents() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    int count() const;
+    bool contains(const BitTorrent::InfoHash &hash) const;
+    BitTorrent::TorrentHandle *value(const BitTorrent::InfoHash &hash) const;
+
+    void insert(BitTorrent::TorrentHandle *torrent);
+    // The last torrent is moved into the place of the removed one
+    BitTorrent::TorrentHandle *take(const BitTorrent::InfoHash &hash);
+
+    // Copies the current values of `torrent` into the status table
+    void updateStatus(const BitTorrent::TorrentHandle *torrent);
+    const StatusTable &status() const;
+
+    qint64 totalPeers() const;
+
+private:
+    void setStatus(int index, const BitTorrent::TorrentHandle *torrent);
+
+    QVector<BitTorrent::TorrentHandle *> m_torrents;
+    QHash<BitTorrent::InfoHash, int> m_indexes;
+    StatusTable m_status;
+};
@@ -39,6 +39,7 @@
 #include <iphlpapi.h>
 #endif
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QHostAddress>
@@ -84,15 +85,19 @@
 #include "base/utils/net.h"
 #include "base/utils/random.h"
 #include "magneturi.h"
+#include "private/bandwidthpoolallocator.h"
 #include "private/bandwidthscheduler.h"
 #include "private/filterparserthread.h"
+#include "private/ipbanmanager.h"
 #include "private/ltunderlyingtype.h"
+#include "private/peerbanpolicy.h"
 #include "private/portforwarderimpl.h"
 #include "private/resumedatasavingmanager.h"
 #include "private/statistics.h"
 #include "torrenthandle.h"
 #include "tracker.h"
 #include "trackerentry.h"
+#include "traffichistory.h"
 
 #if defined(Q_OS_WIN) && (_WIN32_WINNT < 0x0600)
 using NETIO_STATUS = LONG;
@@ -101,6 +106,7 @@ using NETIO_STATUS = LONG;
 static const char PEER_ID[] = "qB";
 static const char RESUME_FOLDER[] = "BT_backup";
 static const char USER_AGENT[] = "qBittorrent/" QBT_VERSION_2;
+static const quint64 BLOCK_SIZE = 16 * 1024;  // libtorrent disk block size
 
 using namespace BitTorrent;
 
@@ -122,6 +128,10 @@ namespace
     using LTString = lt::string_view;
 #endif
 
+    // The peers of every torrent are checked once per period, a batch of torrents on each tick
+    const int PEER_BAN_SCAN_PERIOD = 30000;
+    const int PEER_BAN_SCAN_TICK = 1000;
+
     bool readFile(const QString &path, QByteArray &buf);
     bool loadTorrentResumeData(const QByteArray &data, CreateTorrentParams &torrentParams, int &queuePos, MagnetUri &magnetUri);
 
@@ -188,6 +198,24 @@ namespace
         return expanded;
     }
 
+    BandwidthPoolLimits bandwidthPoolLimitsFromMap(const QVariantMap &map)
+    {
+        BandwidthPoolLimits limits;
+        limits.downloadLimit = map.value(QLatin1String("DownloadLimit")).toInt();
+        limits.uploadLimit = map.value(QLatin1String("UploadLimit")).toInt();
+        limits.maxConnections = map.value(QLatin1String("MaxConnections")).toInt();
+        return limits;
+    }
+
+    QVariantMap bandwidthPoolLimitsToMap(const BandwidthPoolLimits &limits)
+    {
+        return {
+            {QLatin1String("DownloadLimit"), limits.downloadLimit},
+            {QLatin1String("UploadLimit"), limits.uploadLimit},
+            {QLatin1String("MaxConnections"), limits.maxConnections}
+        };
+    }
+
     template <typename T>
     struct LowerLimited
     {
@@ -244,6 +272,7 @@ Session::Session(QObject *parent)
     : QObject(parent)
     , m_deferredConfigureScheduled(false)
     , m_IPFilteringChanged(false)
+    , m_IPFilterApplyScheduled(false)
     , m_listenInterfaceChanged(true)
     , m_isDHTEnabled(BITTORRENT_SESSION_KEY("DHTEnabled"), true)
     , m_isLSDEnabled(BITTORRENT_SESSION_KEY("LSDEnabled"), true)
@@ -311,6 +340,8 @@ Session::Session(QObject *parent)
     , m_altGlobalUploadSpeedLimit(BITTORRENT_SESSION_KEY("AlternativeGlobalUPSpeedLimit"), 10, lowerLimited(0))
     , m_isAltGlobalSpeedLimitEnabled(BITTORRENT_SESSION_KEY("UseAlternativeGlobalSpeedLimit"), false)
     , m_isBandwidthSchedulerEnabled(BITTORRENT_SESSION_KEY("BandwidthSchedulerEnabled"), false)
+    , m_bandwidthSchedule(BITTORRENT_SESSION_KEY("BandwidthSchedule"))
+    , m_isAdaptiveUploadEnabled(BITTORRENT_SESSION_KEY("BandwidthSchedulerAdaptiveUpload"), false)
     , m_saveResumeDataInterval(BITTORRENT_SESSION_KEY("SaveResumeDataInterval"), 60)
     , m_port(BITTORRENT_SESSION_KEY("Port"), -1)
     , m_useRandomPort(BITTORRENT_SESSION_KEY("UseRandomPort"), false)
@@ -326,6 +357,8 @@ Session::Session(QObject *parent)
         , clampValue(SeedChokingAlgorithm::RoundRobin, SeedChokingAlgorithm::AntiLeech))
     , m_storedCategories(BITTORRENT_SESSION_KEY("Categories"))
     , m_storedTags(BITTORRENT_SESSION_KEY("Tags"))
+    , m_categoryBandwidthPools(BITTORRENT_SESSION_KEY("CategoryBandwidthPools"))
+    , m_tagBandwidthPools(BITTORRENT_SESSION_KEY("TagBandwidthPools"))
     , m_maxRatioAction(BITTORRENT_SESSION_KEY("MaxRatioAction"), Pause)
     , m_defaultSavePath(BITTORRENT_SESSION_KEY("DefaultSavePath"), specialFolderLocation(SpecialFolder::Downloads), normalizePath)
     , m_tempPath(BITTORRENT_SESSION_KEY("TempPath"), defaultSavePath() + "temp/", normalizePath)
@@ -345,10 +378,18 @@ Session::Session(QObject *parent)
                             return tmp;
                         }
                  )
+    , m_isPeerBanPolicyEnabled(BITTORRENT_SESSION_KEY("PeerBanPolicy/Enabled"), false)
+    , m_isFakeProgressBanEnabled(BITTORRENT_SESSION_KEY("PeerBanPolicy/FakeProgress"), true)
+    , m_isLeechOnlyBanEnabled(BITTORRENT_SESSION_KEY("PeerBanPolicy/LeechOnly"), false)
+    , m_peerBanBlockedClients(BITTORRENT_SESSION_KEY("PeerBanPolicy/BlockedClients")
+        , {"-XL", "-SD", "-QD", "Xunlei", "QQDownload"})
+    , m_peerBanHashFailureLimit(BITTORRENT_SESSION_KEY("PeerBanPolicy/HashFailureLimit"), 3, lowerLimited(0))
+    , m_peerBanDuration(BITTORRENT_SESSION_KEY("PeerBanPolicy/BanDuration"), 60, lowerLimited(0))
     , m_wasPexEnabled(m_isPeXEnabled)
     , m_numResumeData(0)
     , m_extraLimit(0)
     , m_recentErroredTorrentsTimer(new QTimer(this))
+    , m_torrentsQueueSaveTimer(new QTimer(this))
 {
     if (port() < 0)
         m_port = Utils::Random::rand(1024, 65535);
@@ -359,6 +400,14 @@ Session::Session(QObject *parent)
     m_recentErroredTorrentsTimer->setInterval(1000);
     connect(m_recentErroredTorrentsTimer, &QTimer::timeout, this, [this]() { m_recentErroredTorrents.clear(); });
 
+    m_torrentsQueueSaveTimer->setSingleShot(true);
+    m_torrentsQueueSaveTimer->setInterval(2000);
+    connect(m_torrentsQueueSaveTimer, &QTimer::timeout, this, [this]()
+    {
+        if (isQueueingSystemEnabled())
+            saveTorrentsQueue();
+    });
+
     m_seedingLimitTimer = new QTimer(this);
     m_seedingLimitTimer->setInterval(10000);
     connect(m_seedingLimitTimer, &QTimer::timeout, this, &Session::processShareLimits);
@@ -437,15 +486,25 @@ Session::Session(QObject *parent)
     if (isBandwidthSchedulerEnabled())
         enableBandwidthScheduler();
 
+    m_ipBanManager = new IPBanManager;
+    m_ipBanManager->setPermanentBans(m_bannedIPs);
+    m_banExpiryTimer = new QTimer(this);
+    m_banExpiryTimer->setSingleShot(true);
+    connect(m_banExpiryTimer, &QTimer::timeout, this, &Session::removeExpiredBans);
+
+    m_peerBanPolicy = new PeerBanPolicy;
+    m_peerBanScanTimer = new QTimer(this);
+    m_peerBanScanTimer->setInterval(PEER_BAN_SCAN_TICK);
+    connect(m_peerBanScanTimer, &QTimer::timeout, this, &Session::scanPeersForBans);
+    configurePeerBanPolicy();
+
     if (isIPFilteringEnabled()) {
         // Manually banned IPs are handled in that function too(in the slots)
         enableIPFilter();
     }
     else {
         // Add the banned IPs
-        lt::ip_filter filter;
-        processBannedIPs(filter);
-        m_nativeSession->set_ip_filter(filter);
+        applyIPFilter();
     }
 
     m_categories = map_cast(m_storedCategories);
@@ -463,6 +522,7 @@ Session::Session(QObject *parent)
     m_refreshTimer->start();
 
     m_statistics = new Statistics(this);
+    m_trafficHistory = new TrafficHistory(this);
 
     updateSeedingLimitTimer();
     populateAdditionalTrackers();
@@ -756,6 +816,7 @@ bool Session::removeCategory(const QString &name)
     if (result) {
         // update stored categories
         m_storedCategories = map_cast(m_categories);
+        removeBandwidthPools(BandwidthPoolType::Category, name);
         emit categoryRemoved(name);
     }
 
@@ -783,6 +844,7 @@ void Session::setSubcategoriesEnabled(const bool value)
     }
 
     m_isSubcategoriesEnabled = value;
+    m_bandwidthPoolsChanged = true;
     emit subcategoriesSupportChanged();
 }
 
@@ -821,12 +883,148 @@ bool Session::removeTag(const QString &tag)
         for (TorrentHandle *const torrent : asConst(torrents()))
             torrent->removeTag(tag);
         m_storedTags = m_tags.toList();
+        removeBandwidthPools(BandwidthPoolType::Tag, tag);
         emit tagRemoved(tag);
         return true;
     }
     return false;
 }
 
+BandwidthPoolLimits Session::bandwidthPoolLimits(const BandwidthPoolType type, const QString &name) const
+{
+    const QVariantMap pools = (type == BandwidthPoolType::Category)
+        ? m_categoryBandwidthPools.value() : m_tagBandwidthPools.value();
+    return bandwidthPoolLimitsFromMap(pools.value(name).toMap());
+}
+
+void Session::setBandwidthPoolLimits(const BandwidthPoolType type, const QString &name, const BandwidthPoolLimits &limits)
+{
+    CachedSettingValue<QVariantMap> &storedPools = (type == BandwidthPoolType::Category)
+        ? m_categoryBandwidthPools : m_tagBandwidthPools;
+
+    QVariantMap pools = storedPools;
+    if (limits.isEmpty())
+        pools.remove(name);
+    else
+        pools[name] = bandwidthPoolLimitsToMap(limits);
+
+    if (pools == storedPools.value()) return;
+
+    storedPools = pools;
+    m_bandwidthPoolsChanged = true;
+}
+
+// Removes the pool of a category or tag that is removed, along with the pools of its subcategories
+void Session::removeBandwidthPools(const BandwidthPoolType type, const QString &name)
+{
+    CachedSettingValue<QVariantMap> &storedPools = (type == BandwidthPoolType::Category)
+        ? m_categoryBandwidthPools : m_tagBandwidthPools;
+
+    QVariantMap pools = storedPools;
+    const QString subcategoryPrefix = name + '/';
+    Algorithm::removeIf(pools, [type, &name, &subcategoryPrefix](const QString &poolName, const QVariant &)
+    {
+        return ((poolName == name)
+                || ((type == BandwidthPoolType::Category) && poolName.startsWith(subcategoryPrefix)));
+    });
+
+    if (pools.size() != storedPools.value().size()) {
+        storedPools = pools;
+        m_bandwidthPoolsChanged = true;
+    }
+}
+
+QVector<BandwidthPoolStatus> Session::bandwidthPools() const
+{
+    QVector<BandwidthPoolStatus> pools;
+    pools.reserve(m_bandwidthPools.size());
+    for (const BandwidthPool &pool : m_bandwidthPools)
+        pools << pool.status;
+    return pools;
+}
+
+// Shares out the limits of each pool among its torrents according to their current rates
+void Session::updateBandwidthPools()
+{
+    if (m_bandwidthPoolsChanged) {
+        m_bandwidthPoolsChanged = false;
+        m_bandwidthPools.clear();
+
+        const auto addPools = [this](const BandwidthPoolType type, const QVariantMap &pools)
+        {
+            for (auto it = pools.cbegin(); it != pools.cend(); ++it) {
+                BandwidthPool pool;
+                pool.status.type = type;
+                pool.status.name = it.key();
+                pool.status.limits = bandwidthPoolLimitsFromMap(it.value().toMap());
+                if (pool.status.limits.isEmpty()) continue;
+
+                const QVector<TorrentHandle *> torrents = m_torrents.torrents();
+                for (int i = 0; i < torrents.size(); ++i) {
+                    const bool isMember = (type == BandwidthPoolType::Category)
+                        ? torrents[i]->belongsToCategory(pool.status.name)
+                        : torrents[i]->hasTag(pool.status.name);
+                    if (isMember)
+                        pool.members << i;
+                }
+                pool.status.torrentsCount = pool.members.size();
+
+                m_bandwidthPools << pool;
+            }
+        };
+        addPools(BandwidthPoolType::Category, m_categoryBandwidthPools);
+        addPools(BandwidthPoolType::Tag, m_tagBandwidthPools);
+    }
+
+    if (m_bandwidthPools.isEmpty() && m_pooledTorrents.isEmpty())
+        return;
+
+    const QVector<TorrentHandle *> torrents = m_torrents.torrents();
+    const TorrentRegistry::StatusTable &status = m_torrents.status();
+    QHash<TorrentHandle *, BandwidthPoolLimits> torrentLimits;
+
+    for (BandwidthPool &pool : m_bandwidthPools) {
+        const int count = pool.members.size();
+        QVector<int> downloadRates;
+        QVector<int> uploadRates;
+        downloadRates.reserve(count);
+        uploadRates.reserve(count);
+        pool.status.downloadRate = 0;
+        pool.status.uploadRate = 0;
+        for (const int index : asConst(pool.members)) {
+            downloadRates << status.downloadPayloadRates[index];
+            uploadRates << status.uploadPayloadRates[index];
+            pool.status.downloadRate += status.downloadPayloadRates[index];
+            pool.status.uploadRate += status.uploadPayloadRates[index];
+        }
+
+        const BandwidthPoolLimits &limits = pool.status.limits;
+        const QVector<int> downloadShares = BandwidthPoolAllocator::share(limits.downloadLimit, downloadRates);
+        const QVector<int> uploadShares = BandwidthPoolAllocator::share(limits.uploadLimit, uploadRates);
+        const QVector<int> connectionsShares = BandwidthPoolAllocator::shareConnections(limits.maxConnections, count);
+
+        // a torrent in several pools gets the lowest of its shares
+        for (int k = 0; k < count; ++k) {
+            BandwidthPoolLimits &torrentLimit = torrentLimits[torrents[pool.members[k]]];
+            torrentLimit.downloadLimit = BandwidthPoolAllocator::combineLimits(torrentLimit.downloadLimit, downloadShares[k]);
+            torrentLimit.uploadLimit = BandwidthPoolAllocator::combineLimits(torrentLimit.uploadLimit, uploadShares[k]);
+            torrentLimit.maxConnections = BandwidthPoolAllocator::combineLimits(torrentLimit.maxConnections, connectionsShares[k]);
+        }
+    }
+
+    // torrents that left all pools get their own limits back
+    for (TorrentHandle *const torrent : asConst(m_pooledTorrents)) {
+        if (!torrentLimits.contains(torrent))
+            torrent->setPoolLimits({});
+    }
+
+    m_pooledTorrents.clear();
+    for (auto it = torrentLimits.cbegin(); it != torrentLimits.cend(); ++it) {
+        it.key()->setPoolLimits(it.value());
+        m_pooledTorrents.insert(it.key());
+    }
+}
+
 bool Session::isAutoTMMDisabledByDefault() const
 {
     return m_isAutoTMMDisabledByDefault;
@@ -906,7 +1104,7 @@ void Session::setGlobalMaxRatio(qreal ratio)
 
     if (ratio != globalMaxRatio()) {
         m_globalMaxRatio = ratio;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitChecks();
     }
 }
 
@@ -922,7 +1120,7 @@ void Session::setGlobalMaxSeedingMinutes(int minutes)
 
     if (minutes != globalMaxSeedingMinutes()) {
         m_globalMaxSeedingMinutes = minutes;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitChecks();
     }
 }
 
@@ -936,6 +1134,8 @@ Session::~Session()
     // before we delete lt::session
     if (m_filterParser)
         delete m_filterParser;
+    delete m_ipBanManager;
+    delete m_peerBanPolicy;
 
     // We must delete PortForwarderImpl before
     // we delete lt::session
@@ -1007,16 +1207,44 @@ void Session::configure()
     qDebug("Session configured");
 }
 
-void Session::processBannedIPs(lt::ip_filter &filter)
+void Session::applyIPFilter()
 {
-    // First, import current filter
-    for (const QString &ip : asConst(m_bannedIPs.value())) {
-        boost::system::error_code ec;
-        const lt::address addr = lt::address::from_string(ip.toLatin1().constData(), ec);
-        Q_ASSERT(!ec);
-        if (!ec)
-            filter.add_rule(addr, addr, lt::ip_filter::blocked);
+    m_IPFilterApplyScheduled = false;
+    m_nativeSession->set_ip_filter(m_ipBanManager->filter());
+}
+
+void Session::applyIPFilterDeferred()
+{
+    if (m_IPFilterApplyScheduled)
+        return;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(this, &Session::applyIPFilter, Qt::QueuedConnection);
+#else
+    QMetaObject::invokeMethod(this, "applyIPFilter", Qt::QueuedConnection);
+#endif
+    m_IPFilterApplyScheduled = true;
+}
+
+void Session::removeExpiredBans()
+{
+    if (m_ipBanManager->removeExpired(QDateTime::currentMSecsSinceEpoch()))
+        applyIPFilterDeferred();
+    updateBanExpiryTimer();
+}
+
+void Session::updateBanExpiryTimer()
+{
+    const qint64 nextExpiry = m_ipBanManager->nextExpiryTime();
+    if (nextExpiry == 0) {
+        m_banExpiryTimer->stop();
+        return;
     }
+
+    // QTimer interval is an int, long bans are rechecked once a day
+    const qint64 maxInterval = 24 * 60 * 60 * 1000;
+    const qint64 interval = qBound<qint64>(0, (nextExpiry - QDateTime::currentMSecsSinceEpoch()), maxInterval);
+    m_banExpiryTimer->start(static_cast<int>(interval));
 }
 
 void Session::adjustLimits(lt::settings_pack &settingsPack)
@@ -1033,9 +1261,20 @@ void Session::adjustLimits(lt::settings_pack &settingsPack)
 
 void Session::applyBandwidthLimits(lt::settings_pack &settingsPack) const
 {
-    const bool altSpeedLimitEnabled = isAltGlobalSpeedLimitEnabled();
-    settingsPack.set_int(lt::settings_pack::download_rate_limit, altSpeedLimitEnabled ? altGlobalDownloadSpeedLimit() : globalDownloadSpeedLimit());
-    settingsPack.set_int(lt::settings_pack::upload_rate_limit, altSpeedLimitEnabled ? altGlobalUploadSpeedLimit() : globalUploadSpeedLimit());
+    int downloadLimit = downloadSpeedLimit();
+    int uploadLimit = uploadSpeedLimit();
+
+    // the active slot of the bandwidth schedule takes precedence
+    if (m_scheduledDownloadLimit >= 0) {
+        downloadLimit = m_scheduledDownloadLimit;
+        uploadLimit = m_scheduledUploadLimit;
+    }
+
+    if ((m_uploadBackoffLimit > 0) && ((uploadLimit == 0) || (m_uploadBackoffLimit < uploadLimit)))
+        uploadLimit = m_uploadBackoffLimit;
+
+    settingsPack.set_int(lt::settings_pack::download_rate_limit, downloadLimit);
+    settingsPack.set_int(lt::settings_pack::upload_rate_limit, uploadLimit);
 }
 
 void Session::initMetrics()
@@ -1097,6 +1336,9 @@ void Session::initMetrics()
     m_metricIndices.disk.numBlocksRead = lt::find_metric_idx("disk.num_blocks_read");
     Q_ASSERT(m_metricIndices.disk.numBlocksRead >= 0);
 
+    m_metricIndices.disk.numBlocksWritten = lt::find_metric_idx("disk.num_blocks_written");
+    Q_ASSERT(m_metricIndices.disk.numBlocksWritten >= 0);
+
     m_metricIndices.disk.numBlocksCacheHits = lt::find_metric_idx("disk.num_blocks_cache_hits");
     Q_ASSERT(m_metricIndices.disk.numBlocksCacheHits >= 0);
 
@@ -1471,10 +1713,42 @@ void Session::enableBandwidthScheduler()
         m_bwScheduler = new BandwidthScheduler(this);
         connect(m_bwScheduler.data(), &BandwidthScheduler::bandwidthLimitRequested
                 , this, &Session::setAltGlobalSpeedLimitEnabled);
+        connect(m_bwScheduler.data(), &BandwidthScheduler::activeSlotChanged
+                , this, &Session::handleBandwidthScheduleSlotChanged);
+        connect(m_bwScheduler.data(), &BandwidthScheduler::uploadBackoffRequested
+                , this, &Session::handleUploadBackoffRequested);
     }
+    m_bwScheduler->setSchedule(bandwidthSchedule());
+    m_bwScheduler->setAdaptiveUploadEnabled(isAdaptiveUploadEnabled());
     m_bwScheduler->start();
 }
 
+void Session::handleBandwidthScheduleSlotChanged(const int index)
+{
+    const QVector<BandwidthScheduleSlot> schedule = bandwidthSchedule();
+    if ((index >= 0) && (index < schedule.size())) {
+        m_scheduledDownloadLimit = schedule[index].downloadLimit;
+        m_scheduledUploadLimit = schedule[index].uploadLimit;
+    }
+    else {
+        m_scheduledDownloadLimit = -1;
+        m_scheduledUploadLimit = -1;
+    }
+
+    applyBandwidthLimits();
+}
+
+void Session::handleUploadBackoffRequested(const int limit)
+{
+    if (limit > 0)
+        LogMsg(tr("Upload saturates the link while downloading, limiting it to %1/s").arg(Utils::Misc::friendlyUnit(limit)), Log::INFO);
+    else
+        LogMsg(tr("Upload is no longer limited to leave room for downloads"), Log::INFO);
+
+    m_uploadBackoffLimit = limit;
+    applyBandwidthLimits();
+}
+
 void Session::populateAdditionalTrackers()
 {
     m_additionalTrackerList.clear();
@@ -1491,7 +1765,12 @@ void Session::processShareLimits()
 {
     qDebug("Processing share limits...");
 
-    for (TorrentHandle *const torrent : asConst(torrents())) {
+    // Only the torrents expected to reach their limits by now are checked. The ones that
+    // didn't are scheduled again, the ones that did are left out until their state changes.
+    for (const InfoHash &hash : asConst(m_shareLimitQueue.takeDue(QDateTime::currentMSecsSinceEpoch()))) {
+        TorrentHandle *const torrent = m_torrents.value(hash);
+        if (!torrent) continue;
+
         if (torrent->isSeed() && !torrent->isForced()) {
             if (torrent->ratioLimit() != TorrentHandle::NO_RATIO_LIMIT) {
                 const qreal ratio = torrent->realRatio();
@@ -1543,11 +1822,16 @@ void Session::processShareLimits()
                             torrent->setSuperSeeding(true);
                             LogMsg(tr("'%1' reached the maximum seeding time you set. Enabled super seeding for it.").arg(torrent->name()));
                         }
+                        continue;
                     }
                 }
             }
         }
+
+        scheduleShareLimitCheck(torrent);
     }
+
+    updateSeedingLimitTimer();
 }
 
 // Add to BitTorrent session the downloaded torrent file
@@ -1599,20 +1883,35 @@ bool Session::hasRunningSeed() const
 
 void Session::banIP(const QString &ip)
 {
-    QStringList bannedIPs = m_bannedIPs;
-    if (!bannedIPs.contains(ip)) {
-        lt::ip_filter filter = m_nativeSession->get_ip_filter();
+    banIPs({ip});
+}
+
+void Session::banIPs(const QStringList &ips, const int duration)
+{
+    const qint64 expiryTime = (duration > 0)
+        ? (QDateTime::currentMSecsSinceEpoch() + (duration * qint64(1000)))
+        : 0;
+
+    bool changed = false;
+    for (const QString &ip : ips) {
         boost::system::error_code ec;
         const lt::address addr = lt::address::from_string(ip.toLatin1().constData(), ec);
         Q_ASSERT(!ec);
-        if (ec) return;
-        filter.add_rule(addr, addr, lt::ip_filter::blocked);
-        m_nativeSession->set_ip_filter(filter);
+        if (ec) continue;
 
-        bannedIPs << ip;
-        bannedIPs.sort();
-        m_bannedIPs = bannedIPs;
+        if (m_ipBanManager->ban(addr, expiryTime))
+            changed = true;
     }
+
+    if (!changed)
+        return;
+
+    if (expiryTime == 0)
+        m_bannedIPs = m_ipBanManager->permanentBans();
+    else
+        updateBanExpiryTimer();
+
+    applyIPFilterDeferred();
 }
 
 // Delete a torrent from the session, given its hash
@@ -1622,6 +1921,12 @@ bool Session::deleteTorrent(const QString &hash, const bool deleteLocalFiles)
     TorrentHandle *const torrent = m_torrents.take(hash);
     if (!torrent) return false;
 
+    m_torrentsBatchResumeData.remove(torrent);
+    m_trafficHistory->forgetTorrent(torrent->hash());
+    m_shareLimitQueue.remove(torrent->hash());
+    m_pooledTorrents.remove(torrent);
+    m_bandwidthPoolsChanged = true;
+
     qDebug("Deleting torrent with hash: %s", qUtf8Printable(torrent->hash()));
     emit torrentAboutToBeRemoved(torrent);
 
@@ -1707,7 +2012,7 @@ void Session::increaseTorrentsQueuePos(const QStringList &hashes)
         torrentQueue.pop();
     }
 
-    saveTorrentsQueue();
+    saveTorrentsQueueDeferred();
 }
 
 void Session::decreaseTorrentsQueuePos(const QStringList &hashes)
@@ -1733,7 +2038,7 @@ void Session::decreaseTorrentsQueuePos(const QStringList &hashes)
     for (auto i = m_loadedMetadata.cbegin(); i != m_loadedMetadata.cend(); ++i)
         torrentQueuePositionBottom(m_nativeSession->find_torrent(i.key()));
 
-    saveTorrentsQueue();
+    saveTorrentsQueueDeferred();
 }
 
 void Session::topTorrentsQueuePos(const QStringList &hashes)
@@ -1756,7 +2061,7 @@ void Session::topTorrentsQueuePos(const QStringList &hashes)
         torrentQueue.pop();
     }
 
-    saveTorrentsQueue();
+    saveTorrentsQueueDeferred();
 }
 
 void Session::bottomTorrentsQueuePos(const QStringList &hashes)
@@ -1782,7 +2087,93 @@ void Session::bottomTorrentsQueuePos(const QStringList &hashes)
     for (auto i = m_loadedMetadata.cbegin(); i != m_loadedMetadata.cend(); ++i)
         torrentQueuePositionBottom(m_nativeSession->find_torrent(i.key()));
 
-    saveTorrentsQueue();
+    saveTorrentsQueueDeferred();
+}
+
+void Session::beginTorrentsBatch()
+{
+    ++m_torrentsBatchDepth;
+}
+
+void Session::endTorrentsBatch()
+{
+    Q_ASSERT(m_torrentsBatchDepth > 0);
+    if (--m_torrentsBatchDepth > 0)
+        return;
+
+    const QSet<TorrentHandle *> changedTorrents = m_torrentsBatchResumeData;
+    m_torrentsBatchResumeData.clear();
+    for (TorrentHandle *const torrent : changedTorrents)
+        torrent->saveResumeData();
+
+    emit torrentsUpdated();
+}
+
+bool Session::applyTorrentsBatch(const QVector<TorrentHandle *> &torrents, const TorrentBatchParams &params)
+{
+    // Check the params first, so that the batch is applied either entirely or not at all
+    if (params.changeCategory && !params.category.isEmpty() && !m_categories.contains(params.category))
+        return false;
+    for (const QString &tag : params.addTags) {
+        if (!isValidTag(tag))
+            return false;
+    }
+
+    const QString savePath = params.savePath.isEmpty() ? QString {} : Utils::Fs::expandPathAbs(params.savePath);
+
+    beginTorrentsBatch();
+
+    for (TorrentHandle *const torrent : torrents) {
+        if (params.paused == TriStateBool::True)
+            torrent->pause();
+        else if (params.paused == TriStateBool::False)
+            torrent->resume();
+        if (params.forceStart != TriStateBool::Undefined)
+            torrent->resume(params.forceStart == TriStateBool::True);
+
+        if (params.useAutoTMM != TriStateBool::Undefined)
+            torrent->setAutoTMMEnabled(params.useAutoTMM == TriStateBool::True);
+        if (params.changeCategory)
+            torrent->setCategory(params.category);
+
+        if (params.removeAllTags)
+            torrent->removeAllTags();
+        for (const QString &tag : params.removeTags)
+            torrent->removeTag(tag);
+        for (const QString &tag : params.addTags)
+            torrent->addTag(tag);
+
+        if (!savePath.isEmpty())
+            torrent->move(savePath);
+
+        if (params.changeShareLimits) {
+            torrent->setRatioLimit(params.ratioLimit);
+            torrent->setSeedingTimeLimit(params.seedingTimeLimit);
+        }
+        if (params.uploadLimit >= -1)
+            torrent->setUploadLimit(params.uploadLimit);
+        if (params.downloadLimit >= -1)
+            torrent->setDownloadLimit(params.downloadLimit);
+
+        if (params.sequentialDownload != TriStateBool::Undefined)
+            torrent->setSequentialDownload(params.sequentialDownload == TriStateBool::True);
+        if (params.firstLastPiecePriority != TriStateBool::Undefined)
+            torrent->setFirstLastPiecePriority(params.firstLastPiecePriority == TriStateBool::True);
+        if (params.superSeeding != TriStateBool::Undefined)
+            torrent->setSuperSeeding(params.superSeeding == TriStateBool::True);
+    }
+
+    endTorrentsBatch();
+    return true;
+}
+
+bool Session::deferTorrentResumeDataSaving(TorrentHandle *const torrent)
+{
+    if (m_torrentsBatchDepth == 0)
+        return false;
+
+    m_torrentsBatchResumeData.insert(torrent);
+    return true;
 }
 
 void Session::handleTorrentSaveResumeDataRequested(const TorrentHandle *torrent)
@@ -1791,9 +2182,14 @@ void Session::handleTorrentSaveResumeDataRequested(const TorrentHandle *torrent)
     ++m_numResumeData;
 }
 
-QHash<InfoHash, TorrentHandle *> Session::torrents() const
+QVector<TorrentHandle *> Session::torrents() const
 {
-    return m_torrents;
+    return m_torrents.torrents();
+}
+
+qint64 Session::totalPeersCount() const
+{
+    return m_torrents.totalPeers();
 }
 
 TorrentStatusReport Session::torrentStatusReport() const
@@ -2203,17 +2599,31 @@ void Session::saveResumeData()
 
 void Session::saveTorrentsQueue()
 {
-    QMap<int, QString> queue; // Use QMap since it should be ordered by key
-    for (const TorrentHandle *torrent : asConst(torrents())) {
-        // We require actual (non-cached) queue position here!
-        const int queuePos = LTUnderlyingType<LTQueuePosition> {torrent->nativeHandle().queue_position()};
-        if (queuePos >= 0)
-            queue[queuePos] = torrent->hash();
+    m_torrentsQueueSaveTimer->stop();
+
+    // We require actual (non-cached) queue positions here, get them
+    // all at once instead of asking every torrent handle for its own
+    std::vector<lt::torrent_status> statuses;
+    m_nativeSession->get_torrent_status(&statuses, [](const lt::torrent_status &) { return true; });
+
+    std::vector<std::pair<int, InfoHash>> queue;
+    queue.reserve(statuses.size());
+    for (const lt::torrent_status &status : statuses) {
+        const int queuePos = LTUnderlyingType<LTQueuePosition> {status.queue_position};
+        if ((queuePos >= 0) && m_torrents.contains(status.info_hash))
+            queue.emplace_back(queuePos, status.info_hash);
     }
+    std::sort(queue.begin(), queue.end()
+        , [](const std::pair<int, InfoHash> &left, const std::pair<int, InfoHash> &right) { return (left.first < right.first); });
 
     QByteArray data;
-    for (const QString &hash : asConst(queue))
-        data += (hash.toLatin1() + '\n');
+    data.reserve(static_cast<int>(queue.size()) * 41);
+    for (const auto &item : queue)
+        data += (QString(item.second).toLatin1() + '\n');
+
+    if (data == m_savedTorrentsQueue)
+        return;
+    m_savedTorrentsQueue = data;
 
     const QString filename = QLatin1String {"queue"};
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
@@ -2225,8 +2635,17 @@ void Session::saveTorrentsQueue()
 #endif
 }
 
+void Session::saveTorrentsQueueDeferred()
+{
+    if (!m_torrentsQueueSaveTimer->isActive())
+        m_torrentsQueueSaveTimer->start();
+}
+
 void Session::removeTorrentsQueue()
 {
+    m_torrentsQueueSaveTimer->stop();
+    m_savedTorrentsQueue.clear();
+
     const QString filename = QLatin1String {"queue"};
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
     QMetaObject::invokeMethod(m_resumeDataSavingManager
@@ -2499,11 +2918,58 @@ void Session::setBandwidthSchedulerEnabled(const bool enabled)
 {
     if (enabled != isBandwidthSchedulerEnabled()) {
         m_isBandwidthSchedulerEnabled = enabled;
-        if (enabled)
+        if (enabled) {
             enableBandwidthScheduler();
-        else
+        }
+        else {
             delete m_bwScheduler;
+            m_scheduledDownloadLimit = -1;
+            m_scheduledUploadLimit = -1;
+            m_uploadBackoffLimit = 0;
+            applyBandwidthLimits();
+        }
+    }
+}
+
+QVector<BandwidthScheduleSlot> Session::bandwidthSchedule() const
+{
+    QVector<BandwidthScheduleSlot> schedule;
+    for (const QVariant &value : asConst(m_bandwidthSchedule.value())) {
+        const BandwidthScheduleSlot slot = BandwidthScheduleSlot::fromVariantMap(value.toMap());
+        if (slot.isValid())
+            schedule << slot;
     }
+    return schedule;
+}
+
+void Session::setBandwidthSchedule(const QVector<BandwidthScheduleSlot> &schedule)
+{
+    QVariantList value;
+    value.reserve(schedule.size());
+    for (const BandwidthScheduleSlot &slot : schedule) {
+        if (slot.isValid())
+            value << slot.toVariantMap();
+    }
+
+    if (value == m_bandwidthSchedule.value()) return;
+
+    m_bandwidthSchedule = value;
+    if (m_bwScheduler)
+        m_bwScheduler->setSchedule(bandwidthSchedule());
+}
+
+bool Session::isAdaptiveUploadEnabled() const
+{
+    return m_isAdaptiveUploadEnabled;
+}
+
+void Session::setAdaptiveUploadEnabled(const bool enabled)
+{
+    if (enabled == isAdaptiveUploadEnabled()) return;
+
+    m_isAdaptiveUploadEnabled = enabled;
+    if (m_bwScheduler)
+        m_bwScheduler->setAdaptiveUploadEnabled(enabled);
 }
 
 uint Session::saveResumeDataInterval() const
@@ -2732,11 +3198,11 @@ void Session::setBannedIPs(const QStringList &newList)
     if (filteredList == m_bannedIPs)
         return; // do nothing
     // store to session settings
-    // also here we have to recreate filter list including 3rd party ban file
-    // and install it again into m_session
+    // the 3rd party ban file rules are kept apart so there is no need to parse it again
     m_bannedIPs = filteredList;
-    m_IPFilteringChanged = true;
-    configureDeferred();
+    m_ipBanManager->setPermanentBans(filteredList);
+    updateBanExpiryTimer();
+    applyIPFilterDeferred();
 }
 
 QStringList Session::bannedIPs() const
@@ -2744,6 +3210,176 @@ QStringList Session::bannedIPs() const
     return m_bannedIPs;
 }
 
+bool Session::isPeerBanPolicyEnabled() const
+{
+    return m_isPeerBanPolicyEnabled;
+}
+
+void Session::setPeerBanPolicyEnabled(const bool enabled)
+{
+    if (enabled == m_isPeerBanPolicyEnabled)
+        return;
+
+    m_isPeerBanPolicyEnabled = enabled;
+    configurePeerBanPolicy();
+}
+
+bool Session::isFakeProgressBanEnabled() const
+{
+    return m_isFakeProgressBanEnabled;
+}
+
+void Session::setFakeProgressBanEnabled(const bool enabled)
+{
+    if (enabled == m_isFakeProgressBanEnabled)
+        return;
+
+    m_isFakeProgressBanEnabled = enabled;
+    configurePeerBanPolicy();
+}
+
+bool Session::isLeechOnlyBanEnabled() const
+{
+    return m_isLeechOnlyBanEnabled;
+}
+
+void Session::setLeechOnlyBanEnabled(const bool enabled)
+{
+    if (enabled == m_isLeechOnlyBanEnabled)
+        return;
+
+    m_isLeechOnlyBanEnabled = enabled;
+    configurePeerBanPolicy();
+}
+
+QStringList Session::peerBanBlockedClients() const
+{
+    return m_peerBanBlockedClients;
+}
+
+void Session::setPeerBanBlockedClients(const QStringList &clients)
+{
+    QStringList filteredList;
+    for (const QString &client : clients) {
+        const QString trimmed = client.trimmed();
+        if (!trimmed.isEmpty())
+            filteredList << trimmed;
+    }
+    filteredList.removeDuplicates();
+
+    if (filteredList == m_peerBanBlockedClients)
+        return;
+
+    m_peerBanBlockedClients = filteredList;
+    configurePeerBanPolicy();
+}
+
+int Session::peerBanHashFailureLimit() const
+{
+    return m_peerBanHashFailureLimit;
+}
+
+void Session::setPeerBanHashFailureLimit(int limit)
+{
+    limit = std::max(limit, 0);
+    if (limit == m_peerBanHashFailureLimit)
+        return;
+
+    m_peerBanHashFailureLimit = limit;
+    configurePeerBanPolicy();
+}
+
+int Session::peerBanDuration() const
+{
+    return m_peerBanDuration;
+}
+
+void Session::setPeerBanDuration(const int minutes)
+{
+    // a negative duration would make the bans permanent
+    m_peerBanDuration = std::max(minutes, 0);
+}
+
+PeerBanStatistics Session::peerBanStatistics() const
+{
+    return m_peerBanPolicy->statistics();
+}
+
+void Session::configurePeerBanPolicy()
+{
+    const bool enabled = isPeerBanPolicyEnabled();
+    m_peerBanPolicy->setFakeProgressEnabled(enabled && isFakeProgressBanEnabled());
+    m_peerBanPolicy->setLeechOnlyEnabled(enabled && isLeechOnlyBanEnabled());
+    m_peerBanPolicy->setBlockedClients(enabled ? peerBanBlockedClients() : QStringList());
+    m_peerBanPolicy->setHashFailureLimit(enabled ? peerBanHashFailureLimit() : 0);
+
+    if (enabled)
+        m_peerBanScanTimer->start();
+    else
+        m_peerBanScanTimer->stop();
+}
+
+void Session::scanPeersForBans()
+{
+    const auto ruleName = [](const PeerBanPolicy::Rule rule) -> QString
+    {
+        switch (rule) {
+        case PeerBanPolicy::Rule::FakeProgress:
+            return tr("fake progress");
+        case PeerBanPolicy::Rule::LeechOnly:
+            return tr("leeching only");
+        case PeerBanPolicy::Rule::BlockedClient:
+            return tr("blocked client");
+        default:
+            return {};
+        }
+    };
+
+    // get_peer_info() blocks until libtorrent answers, so the torrents are spread over the ticks
+    const QVector<TorrentHandle *> &torrents = m_torrents.torrents();
+    const int ticksPerPeriod = PEER_BAN_SCAN_PERIOD / PEER_BAN_SCAN_TICK;
+    const int batchSize = (torrents.size() + ticksPerPeriod - 1) / ticksPerPeriod;
+    if (m_peerBanScanPosition >= torrents.size())
+        m_peerBanScanPosition = 0;
+    const int batchEnd = std::min((m_peerBanScanPosition + batchSize), torrents.size());
+
+    QSet<QString> offenders;
+    std::vector<lt::peer_info> peers;
+    for (int i = m_peerBanScanPosition; i < batchEnd; ++i) {
+        const TorrentHandle *torrent = torrents[i];
+        if (torrent->isPaused() || (torrent->peersCount() == 0))
+            continue;
+
+        PeerBanPolicy::TorrentState torrentState;
+        torrentState.totalSize = torrent->totalSize();
+        torrentState.isSeed = torrent->isSeed();
+
+        torrent->nativeHandle().get_peer_info(peers);
+        for (const lt::peer_info &peer : peers) {
+            const PeerBanPolicy::Rule rule = m_peerBanPolicy->check(peer, torrentState);
+            if (rule == PeerBanPolicy::Rule::None)
+                continue;
+
+            boost::system::error_code ec;
+            const std::string ip = peer.ip.address().to_string(ec);
+            if (ec) continue;
+
+            const QString address = QString::fromLatin1(ip.c_str());
+            if (offenders.contains(address))
+                continue;
+
+            offenders.insert(address);
+            m_peerBanPolicy->recordHit(rule);
+            Logger::instance()->addPeer(address, false, ruleName(rule));
+        }
+    }
+
+    m_peerBanScanPosition = batchEnd;
+
+    if (!offenders.isEmpty())
+        banIPs(offenders.toList(), (peerBanDuration() * 60));
+}
+
 int Session::maxConnectionsPerTorrent() const
 {
     return m_maxConnectionsPerTorrent;
@@ -2763,6 +3399,13 @@ void Session::setMaxConnectionsPerTorrent(int max)
             }
             catch (const std::exception &) {}
         }
+
+        // pooled torrents get their share of connections back on the next update
+        for (TorrentHandle *const torrent : asConst(m_pooledTorrents)) {
+            BandwidthPoolLimits limits = torrent->poolLimits();
+            limits.maxConnections = 0;
+            torrent->setPoolLimits(limits);
+        }
     }
 }
 
@@ -3303,7 +3946,11 @@ MaxRatioAction Session::maxRatioAction() const
 
 void Session::setMaxRatioAction(const MaxRatioAction act)
 {
+    if (act == maxRatioAction()) return;
+
     m_maxRatioAction = static_cast<int>(act);
+    // torrents that already reached their limits may need to be handled differently now
+    rescheduleShareLimitChecks();
 }
 
 // If this functions returns true, we cannot add torrent to session,
@@ -3317,8 +3964,7 @@ bool Session::isKnownTorrent(const InfoHash &hash) const
 
 void Session::updateSeedingLimitTimer()
 {
-    if ((globalMaxRatio() == TorrentHandle::NO_RATIO_LIMIT) && !hasPerTorrentRatioLimit()
-        && (globalMaxSeedingMinutes() == TorrentHandle::NO_SEEDING_TIME_LIMIT) && !hasPerTorrentSeedingTimeLimit()) {
+    if (m_shareLimitQueue.isEmpty()) {
         if (m_seedingLimitTimer->isActive())
             m_seedingLimitTimer->stop();
     }
@@ -3327,9 +3973,68 @@ void Session::updateSeedingLimitTimer()
     }
 }
 
+// Returns the time (msecs since epoch) the torrent is expected to reach one of its
+// share limits at its current upload rate, or -1 if it isn't going to reach any
+qint64 Session::shareLimitDeadline(const TorrentHandle *torrent, const qint64 now) const
+{
+    if (!torrent->isSeed() || torrent->isForced())
+        return -1;
+
+    qint64 deadline = -1;
+
+    qreal ratioLimit = torrent->ratioLimit();
+    if (ratioLimit == TorrentHandle::USE_GLOBAL_RATIO)
+        ratioLimit = globalMaxRatio();
+
+    if (ratioLimit >= 0) {
+        const qreal ratio = torrent->realRatio();
+        if (ratio >= ratioLimit)
+            return now;
+
+        const int uploadRate = torrent->uploadPayloadRate();
+        if (uploadRate > 0) {
+            // the amount the ratio is computed against
+            const qreal downloaded = (ratio > 0) ? (torrent->totalUpload() / ratio) : torrent->totalDownload();
+            const qreal missingUpload = std::max<qreal>(((ratioLimit * downloaded) - torrent->totalUpload()), 0);
+            deadline = now + static_cast<qint64>((missingUpload * 1000) / uploadRate);
+        }
+    }
+
+    int seedingTimeLimit = torrent->seedingTimeLimit();
+    if (seedingTimeLimit == TorrentHandle::USE_GLOBAL_SEEDING_TIME)
+        seedingTimeLimit = globalMaxSeedingMinutes();
+
+    if (seedingTimeLimit >= 0) {
+        const qint64 missingTime = std::max<qint64>(((seedingTimeLimit * 60LL) - torrent->seedingTime()), 0);
+        const qint64 seedingTimeDeadline = now + (missingTime * 1000);
+        deadline = (deadline < 0) ? seedingTimeDeadline : std::min(deadline, seedingTimeDeadline);
+    }
+
+    return deadline;
+}
+
+void Session::scheduleShareLimitCheck(const TorrentHandle *torrent)
+{
+    const qint64 deadline = shareLimitDeadline(torrent, QDateTime::currentMSecsSinceEpoch());
+    if (deadline < 0)
+        m_shareLimitQueue.remove(torrent->hash());
+    else
+        m_shareLimitQueue.schedule(torrent->hash(), deadline);
+}
+
+void Session::rescheduleShareLimitChecks()
+{
+    m_shareLimitQueue.clear();
+    for (const TorrentHandle *torrent : asConst(m_torrents))
+        scheduleShareLimitCheck(torrent);
+
+    updateSeedingLimitTimer();
+}
+
 void Session::handleTorrentShareLimitChanged(TorrentHandle *const torrent)
 {
     torrent->saveResumeData();
+    scheduleShareLimitCheck(torrent);
     updateSeedingLimitTimer();
 }
 
@@ -3347,18 +4052,21 @@ void Session::handleTorrentSavePathChanged(TorrentHandle *const torrent)
 void Session::handleTorrentCategoryChanged(TorrentHandle *const torrent, const QString &oldCategory)
 {
     torrent->saveResumeData();
+    m_bandwidthPoolsChanged = true;
     emit torrentCategoryChanged(torrent, oldCategory);
 }
 
 void Session::handleTorrentTagAdded(TorrentHandle *const torrent, const QString &tag)
 {
     torrent->saveResumeData();
+    m_bandwidthPoolsChanged = true;
     emit torrentTagAdded(torrent, tag);
 }
 
 void Session::handleTorrentTagRemoved(TorrentHandle *const torrent, const QString &tag)
 {
     torrent->saveResumeData();
+    m_bandwidthPoolsChanged = true;
     emit torrentTagRemoved(torrent, tag);
 }
 
@@ -3438,6 +4146,8 @@ void Session::handleTorrentPaused(TorrentHandle *const torrent)
 void Session::handleTorrentResumed(TorrentHandle *const torrent)
 {
     torrent->saveResumeData();
+    scheduleShareLimitCheck(torrent);
+    updateSeedingLimitTimer();
     emit torrentResumed(torrent);
 }
 
@@ -3450,6 +4160,8 @@ void Session::handleTorrentFinished(TorrentHandle *const torrent)
 {
     if (!torrent->hasError() && !torrent->hasMissingFiles())
         torrent->saveResumeData();
+    scheduleShareLimitCheck(torrent);
+    updateSeedingLimitTimer();
     emit torrentFinished(torrent);
 
     qDebug("Checking if the torrent contains torrent files to download");
@@ -3523,22 +4235,6 @@ void Session::handleTorrentTrackerWarning(TorrentHandle *const torrent, const QS
     emit trackerWarning(torrent, trackerUrl);
 }
 
-bool Session::hasPerTorrentRatioLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandle *torrent)
-    {
-        return (torrent->ratioLimit() >= 0);
-    });
-}
-
-bool Session::hasPerTorrentSeedingTimeLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandle *torrent)
-    {
-        return (torrent->seedingTimeLimit() >= 0);
-    });
-}
-
 void Session::initResumeFolder()
 {
     m_resumeFolderPath = Utils::Fs::expandPathAbs(specialFolderLocation(SpecialFolder::Data) + RESUME_FOLDER);
@@ -3597,9 +4293,8 @@ void Session::disableIPFilter()
     // Add the banned IPs after the IPFilter disabling
     // which creates an empty filter and overrides all previously
     // applied bans.
-    lt::ip_filter filter;
-    processBannedIPs(filter);
-    m_nativeSession->set_ip_filter(filter);
+    m_ipBanManager->setBaseFilter({});
+    applyIPFilter();
 }
 
 void Session::recursiveTorrentDownload(const InfoHash &hash)
@@ -3767,6 +4462,11 @@ quint64 Session::getAlltimeUL() const
     return m_statistics->getAlltimeUL();
 }
 
+TrafficHistory *Session::trafficHistory() const
+{
+    return m_trafficHistory;
+}
+
 void Session::refresh()
 {
     m_nativeSession->post_torrent_updates();
@@ -3776,9 +4476,8 @@ void Session::refresh()
 void Session::handleIPFilterParsed(const int ruleCount)
 {
     if (m_filterParser) {
-        lt::ip_filter filter = m_filterParser->IPfilter();
-        processBannedIPs(filter);
-        m_nativeSession->set_ip_filter(filter);
+        m_ipBanManager->setBaseFilter(m_filterParser->IPfilter());
+        applyIPFilter();
     }
     LogMsg(tr("Successfully parsed the provided IP filter: %1 rules were applied.", "%1 is a number").arg(ruleCount));
     emit IPFilterParsed(false, ruleCount);
@@ -3786,9 +4485,8 @@ void Session::handleIPFilterParsed(const int ruleCount)
 
 void Session::handleIPFilterError()
 {
-    lt::ip_filter filter;
-    processBannedIPs(filter);
-    m_nativeSession->set_ip_filter(filter);
+    m_ipBanManager->setBaseFilter({});
+    applyIPFilter();
 
     LogMsg(tr("Error: Failed to parse the provided IP filter."), Log::CRITICAL);
     emit IPFilterParsed(true, 0);
@@ -3922,7 +4620,8 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
     const CreateTorrentParams params = m_addingTorrents.take(nativeHandle.info_hash());
 
     TorrentHandle *const torrent = new TorrentHandle(this, nativeHandle, params);
-    m_torrents.insert(torrent->hash(), torrent);
+    m_torrents.insert(torrent);
+    m_bandwidthPoolsChanged = true;
 
     const bool fromMagnetUri = !torrent->hasMetadata();
 
@@ -3956,9 +4655,8 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
         torrent->saveResumeData();
     }
 
-    if (((torrent->ratioLimit() >= 0) || (torrent->seedingTimeLimit() >= 0))
-        && !m_seedingLimitTimer->isActive())
-        m_seedingLimitTimer->start();
+    scheduleShareLimitCheck(torrent);
+    updateSeedingLimitTimer();
 
     // Send torrent addition signal
     emit torrentAdded(torrent);
@@ -4139,8 +4837,19 @@ void Session::handlePeerBanAlert(const lt::peer_ban_alert *p)
     const std::string ip = p->endpoint.address().to_string(ec);
 #endif
 
-    if (!ec)
-        Logger::instance()->addPeer(QString::fromLatin1(ip.c_str()), false);
+    if (ec) return;
+
+    Logger::instance()->addPeer(QString::fromLatin1(ip.c_str()), false);
+
+#if (LIBTORRENT_VERSION_NUM < 10200)
+    if (m_peerBanPolicy->addHashFailure(p->ip.address())) {
+#else
+    if (m_peerBanPolicy->addHashFailure(p->endpoint.address())) {
+#endif
+        m_peerBanPolicy->recordHit(PeerBanPolicy::Rule::HashFailures);
+        Logger::instance()->addPeer(QString::fromLatin1(ip.c_str()), false, tr("too many hash failures"));
+        banIPs({QString::fromLatin1(ip.c_str())}, (peerBanDuration() * 60));
+    }
 }
 
 void Session::handleUrlSeedAlert(const lt::url_seed_alert *p)
@@ -4349,11 +5058,29 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_cacheStatus.averageJobTime = (totalJobs > 0)
                                    ? (stats[m_metricIndices.disk.diskJobTime] / totalJobs) : 0;
 
+    const quint64 totalBlocksRead = stats[m_metricIndices.disk.numBlocksRead];
+    const quint64 totalBlocksWritten = stats[m_metricIndices.disk.numBlocksWritten];
+    const quint64 totalBlocksHashed = stats[m_metricIndices.disk.hashJobs];
+    m_cacheStatus.diskReadRate = calcRate(m_cacheStatus.totalBlocksRead, totalBlocksRead) * BLOCK_SIZE;
+    m_cacheStatus.diskWriteRate = calcRate(m_cacheStatus.totalBlocksWritten, totalBlocksWritten) * BLOCK_SIZE;
+    m_cacheStatus.hashRate = calcRate(m_cacheStatus.totalBlocksHashed, totalBlocksHashed) * BLOCK_SIZE;
+    m_cacheStatus.totalBlocksRead = totalBlocksRead;
+    m_cacheStatus.totalBlocksWritten = totalBlocksWritten;
+    m_cacheStatus.totalBlocksHashed = totalBlocksHashed;
+
+    if (m_bwScheduler) {
+        const int uploadLimit = (m_scheduledUploadLimit >= 0) ? m_scheduledUploadLimit : uploadSpeedLimit();
+        m_bwScheduler->updateLinkUsage(m_status.uploadRate, uploadLimit, (m_torrentStatusReport.nbDownloading > 0));
+    }
+
     emit statsUpdated();
 }
 
 void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
 {
+    QVector<TorrentHandle *> updatedTorrents;
+    updatedTorrents.reserve(static_cast<int>(p->status.size()));
+
     for (const lt::torrent_status &status : p->status) {
         TorrentHandle *const torrent = m_torrents.value(status.info_hash);
 
@@ -4361,8 +5088,17 @@ void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
             continue;
 
         torrent->handleStateUpdate(status);
+        m_torrents.updateStatus(torrent);
+        // upload rate or state could have changed
+        scheduleShareLimitCheck(torrent);
+        updatedTorrents << torrent;
     }
 
+    updateSeedingLimitTimer();
+
+    m_trafficHistory->update(updatedTorrents);
+    updateBandwidthPools();
+
     m_torrentStatusReport = TorrentStatusReport();
     for (const TorrentHandle *torrent : asConst(m_torrents)) {
         if (torrent->isDownloading())
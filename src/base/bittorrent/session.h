@@ -43,9 +43,15 @@
 
 #include "base/settingvalue.h"
 #include "base/types.h"
+#include "private/sharelimitqueue.h"
+#include "private/torrentregistry.h"
 #include "addtorrentparams.h"
+#include "bandwidthpool.h"
+#include "bandwidthscheduleslot.h"
 #include "cachestatus.h"
+#include "peerbanstatistics.h"
 #include "sessionstatus.h"
+#include "torrentbatchparams.h"
 #include "torrentinfo.h"
 
 class QThread;
@@ -55,6 +61,8 @@ class QStringList;
 class QUrl;
 
 class FilterParserThread;
+class IPBanManager;
+class PeerBanPolicy;
 class BandwidthScheduler;
 class Statistics;
 class ResumeDataSavingManager;
@@ -82,6 +90,7 @@ namespace BitTorrent
     class InfoHash;
     class TorrentHandle;
     class Tracker;
+    class TrafficHistory;
     class MagnetUri;
     class TrackerEntry;
     struct CreateTorrentParams;
@@ -174,6 +183,7 @@ namespace BitTorrent
         {
             int diskBlocksInUse = 0;
             int numBlocksRead = 0;
+            int numBlocksWritten = 0;
             int numBlocksCacheHits = 0;
             int writeJobs = 0;
             int readJobs = 0;
@@ -219,6 +229,12 @@ namespace BitTorrent
         bool addTag(const QString &tag);
         bool removeTag(const QString &tag);
 
+        // Rate and connection limits shared by all the torrents of a category (including
+        // its subcategories) or tag. Empty limits remove the pool.
+        BandwidthPoolLimits bandwidthPoolLimits(BandwidthPoolType type, const QString &name) const;
+        void setBandwidthPoolLimits(BandwidthPoolType type, const QString &name, const BandwidthPoolLimits &limits);
+        QVector<BandwidthPoolStatus> bandwidthPools() const;
+
         // Torrent Management Mode subsystem (TMM)
         //
         // Each torrent can be either in Manual mode or in Automatic mode
@@ -282,6 +298,12 @@ namespace BitTorrent
         void setAltGlobalSpeedLimitEnabled(bool enabled);
         bool isBandwidthSchedulerEnabled() const;
         void setBandwidthSchedulerEnabled(bool enabled);
+        // While empty, the scheduler switches to the alternative speed limits
+        // during the period set in Preferences
+        QVector<BandwidthScheduleSlot> bandwidthSchedule() const;
+        void setBandwidthSchedule(const QVector<BandwidthScheduleSlot> &schedule);
+        bool isAdaptiveUploadEnabled() const;
+        void setAdaptiveUploadEnabled(bool enabled);
 
         uint saveResumeDataInterval() const;
         void setSaveResumeDataInterval(uint value);
@@ -391,10 +413,26 @@ namespace BitTorrent
         void setTrackerFilteringEnabled(bool enabled);
         QStringList bannedIPs() const;
         void setBannedIPs(const QStringList &newList);
+        bool isPeerBanPolicyEnabled() const;
+        void setPeerBanPolicyEnabled(bool enabled);
+        bool isFakeProgressBanEnabled() const;
+        void setFakeProgressBanEnabled(bool enabled);
+        bool isLeechOnlyBanEnabled() const;
+        void setLeechOnlyBanEnabled(bool enabled);
+        QStringList peerBanBlockedClients() const;
+        void setPeerBanBlockedClients(const QStringList &clients);
+        int peerBanHashFailureLimit() const;
+        void setPeerBanHashFailureLimit(int limit);
+        int peerBanDuration() const;
+        void setPeerBanDuration(int minutes);
+        PeerBanStatistics peerBanStatistics() const;
 
         void startUpTorrents();
         TorrentHandle *findTorrent(const InfoHash &hash) const;
-        QHash<InfoHash, TorrentHandle *> torrents() const;
+        // Torrents in no particular order, sharing the session's list (no copy is made)
+        QVector<TorrentHandle *> torrents() const;
+        // Sum of TorrentHandle::peersCount() of all torrents as of the last status update
+        qint64 totalPeersCount() const;
         TorrentStatusReport torrentStatusReport() const;
         bool hasActiveTorrents() const;
         bool hasUnfinishedTorrents() const;
@@ -403,12 +441,16 @@ namespace BitTorrent
         const CacheStatus &cacheStatus() const;
         quint64 getAlltimeDL() const;
         quint64 getAlltimeUL() const;
+        TrafficHistory *trafficHistory() const;
         bool isListening() const;
 
         MaxRatioAction maxRatioAction() const;
         void setMaxRatioAction(MaxRatioAction act);
 
         void banIP(const QString &ip);
+        // `duration` is in seconds, 0 bans the addresses permanently.
+        // Temporary bans aren't kept across restarts.
+        void banIPs(const QStringList &ips, int duration = 0);
 
         bool isKnownTorrent(const InfoHash &hash) const;
         bool addTorrent(const QString &source, const AddTorrentParams &params = AddTorrentParams());
@@ -423,7 +465,16 @@ namespace BitTorrent
         void topTorrentsQueuePos(const QStringList &hashes);
         void bottomTorrentsQueuePos(const QStringList &hashes);
 
+        // Changes made to torrents between these calls are handled as a whole: the resume
+        // data of each changed torrent is saved once and torrentsUpdated() is emitted at the end.
+        // The calls can be nested.
+        void beginTorrentsBatch();
+        void endTorrentsBatch();
+        // Nothing is changed if the params are invalid
+        bool applyTorrentsBatch(const QVector<TorrentHandle *> &torrents, const TorrentBatchParams &params);
+
         // TorrentHandle interface
+        bool deferTorrentResumeDataSaving(TorrentHandle *const torrent);
         void handleTorrentSaveResumeDataRequested(const TorrentHandle *torrent);
         void handleTorrentShareLimitChanged(TorrentHandle *const torrent);
         void handleTorrentNameChanged(TorrentHandle *const torrent);
@@ -495,6 +546,9 @@ namespace BitTorrent
         void generateResumeData(bool final = false);
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
+        void applyIPFilter();
+        void removeExpiredBans();
+        void scanPeersForBans();
         void handleDownloadFinished(const Net::DownloadResult &result);
 
         // Session reconfiguration triggers
@@ -512,9 +566,6 @@ namespace BitTorrent
         explicit Session(QObject *parent = nullptr);
         ~Session();
 
-        bool hasPerTorrentRatioLimit() const;
-        bool hasPerTorrentSeedingTimeLimit() const;
-
         void initResumeFolder();
 
         // Session configuration
@@ -526,11 +577,17 @@ namespace BitTorrent
         void initMetrics();
         void adjustLimits();
         void applyBandwidthLimits();
-        void processBannedIPs(lt::ip_filter &filter);
+        void applyIPFilterDeferred();
+        void updateBanExpiryTimer();
+        void configurePeerBanPolicy();
         const QStringList getListeningIPs();
         void configureListeningInterface();
         void enableTracker(bool enable);
         void enableBandwidthScheduler();
+        void handleBandwidthScheduleSlotChanged(int index);
+        void updateBandwidthPools();
+        void removeBandwidthPools(BandwidthPoolType type, const QString &name);
+        void handleUploadBackoffRequested(int limit);
         void populateAdditionalTrackers();
         void enableIPFilter();
         void disableIPFilter();
@@ -541,6 +598,9 @@ namespace BitTorrent
         bool findIncompleteFiles(TorrentInfo &torrentInfo, QString &savePath) const;
 
         void updateSeedingLimitTimer();
+        qint64 shareLimitDeadline(const TorrentHandle *torrent, qint64 now) const;
+        void scheduleShareLimitCheck(const TorrentHandle *torrent);
+        void rescheduleShareLimitChecks();
         void exportTorrentFile(TorrentHandle *const torrent, TorrentExportFolder folder = TorrentExportFolder::Regular);
 
         void handleAlert(const lt::alert *a);
@@ -567,6 +627,7 @@ namespace BitTorrent
 
         void saveResumeData();
         void saveTorrentsQueue();
+        void saveTorrentsQueueDeferred();
         void removeTorrentsQueue();
 
         void getPendingAlerts(std::vector<lt::alert *> &out, ulong time = 0);
@@ -576,6 +637,7 @@ namespace BitTorrent
 
         bool m_deferredConfigureScheduled;
         bool m_IPFilteringChanged;
+        bool m_IPFilterApplyScheduled;
         bool m_listenInterfaceChanged; // optimization
 
         CachedSettingValue<bool> m_isDHTEnabled;
@@ -638,6 +700,8 @@ namespace BitTorrent
         CachedSettingValue<int> m_altGlobalUploadSpeedLimit;
         CachedSettingValue<bool> m_isAltGlobalSpeedLimitEnabled;
         CachedSettingValue<bool> m_isBandwidthSchedulerEnabled;
+        CachedSettingValue<QVariantList> m_bandwidthSchedule;
+        CachedSettingValue<bool> m_isAdaptiveUploadEnabled;
         CachedSettingValue<uint> m_saveResumeDataInterval;
         CachedSettingValue<int> m_port;
         CachedSettingValue<bool> m_useRandomPort;
@@ -651,6 +715,8 @@ namespace BitTorrent
         CachedSettingValue<SeedChokingAlgorithm> m_seedChokingAlgorithm;
         CachedSettingValue<QVariantMap> m_storedCategories;
         CachedSettingValue<QStringList> m_storedTags;
+        CachedSettingValue<QVariantMap> m_categoryBandwidthPools;
+        CachedSettingValue<QVariantMap> m_tagBandwidthPools;
         CachedSettingValue<int> m_maxRatioAction;
         CachedSettingValue<QString> m_defaultSavePath;
         CachedSettingValue<QString> m_tempPath;
@@ -662,6 +728,12 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isDisableAutoTMMWhenCategorySavePathChanged;
         CachedSettingValue<bool> m_isTrackerEnabled;
         CachedSettingValue<QStringList> m_bannedIPs;
+        CachedSettingValue<bool> m_isPeerBanPolicyEnabled;
+        CachedSettingValue<bool> m_isFakeProgressBanEnabled;
+        CachedSettingValue<bool> m_isLeechOnlyBanEnabled;
+        CachedSettingValue<QStringList> m_peerBanBlockedClients;
+        CachedSettingValue<int> m_peerBanHashFailureLimit;
+        CachedSettingValue<int> m_peerBanDuration;
 
         // Order is important. This needs to be declared after its CachedSettingsValue
         // counterpart, because it uses it for initialization in the constructor
@@ -669,6 +741,8 @@ namespace BitTorrent
         const bool m_wasPexEnabled;
 
         int m_numResumeData;
+        int m_torrentsBatchDepth = 0;
+        QSet<TorrentHandle *> m_torrentsBatchResumeData;
         int m_extraLimit;
         QVector<BitTorrent::TrackerEntry> m_additionalTrackerList;
         QString m_resumeFolderPath;
@@ -676,11 +750,32 @@ namespace BitTorrent
 
         QTimer *m_refreshTimer;
         QTimer *m_seedingLimitTimer;
+        ShareLimitQueue m_shareLimitQueue;
         QTimer *m_resumeDataTimer;
         Statistics *m_statistics;
+        TrafficHistory *m_trafficHistory;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
+        // manual bans are merged with the filter file rules and applied to libtorrent once per batch
+        IPBanManager *m_ipBanManager;
+        QTimer *m_banExpiryTimer;
+        PeerBanPolicy *m_peerBanPolicy;
+        QTimer *m_peerBanScanTimer;
+        int m_peerBanScanPosition = 0;  // index in m_torrents of the next torrent to scan
         QPointer<BandwidthScheduler> m_bwScheduler;
+        // limits of the active schedule slot, -1 if there is none
+        int m_scheduledDownloadLimit = -1;
+        int m_scheduledUploadLimit = -1;
+        int m_uploadBackoffLimit = 0;
+
+        struct BandwidthPool
+        {
+            BandwidthPoolStatus status;
+            QVector<int> members;  // indexes in m_torrents
+        };
+        QVector<BandwidthPool> m_bandwidthPools;
+        bool m_bandwidthPoolsChanged = true;
+        QSet<TorrentHandle *> m_pooledTorrents;
         // Tracker
         QPointer<Tracker> m_tracker;
         // fastresume data writing thread
@@ -688,7 +783,7 @@ namespace BitTorrent
         ResumeDataSavingManager *m_resumeDataSavingManager;
 
         QHash<InfoHash, TorrentInfo> m_loadedMetadata;
-        QHash<InfoHash, TorrentHandle *> m_torrents;
+        TorrentRegistry m_torrents;
         QHash<InfoHash, CreateTorrentParams> m_addingTorrents;
         QHash<QString, AddTorrentParams> m_downloadedTorrents;
         QHash<InfoHash, RemovingTorrentData> m_removingTorrents;
@@ -700,6 +795,10 @@ namespace BitTorrent
         QSet<InfoHash> m_recentErroredTorrents;
         QTimer *m_recentErroredTorrentsTimer;
 
+        // queue file saving is delayed so that a burst of queue changes is written once
+        QTimer *m_torrentsQueueSaveTimer;
+        QByteArray m_savedTorrentsQueue;
+
         SessionMetricIndices m_metricIndices;
         lt::time_point m_statsLastTimestamp = lt::clock_type::now();
 
@@ -66,6 +66,7 @@
 #include "downloadpriority.h"
 #include "peeraddress.h"
 #include "peerinfo.h"
+#include "private/bandwidthpoolallocator.h"
 #include "private/ltunderlyingtype.h"
 #include "session.h"
 #include "trackerentry.h"
@@ -552,6 +553,9 @@ bool TorrentHandle::needSaveResumeData() const
 
 void TorrentHandle::saveResumeData()
 {
+    if (m_session->deferTorrentResumeDataSaving(this))
+        return;
+
     m_nativeHandle.save_resume_data();
     m_session->handleTorrentSaveResumeDataRequested(this);
 }
@@ -1163,12 +1167,12 @@ qlonglong TorrentHandle::timeSinceActivity() const
 
 int TorrentHandle::downloadLimit() const
 {
-    return m_nativeHandle.download_limit();
+    return (m_downloadLimit >= 0) ? m_downloadLimit : m_nativeHandle.download_limit();
 }
 
 int TorrentHandle::uploadLimit() const
 {
-    return m_nativeHandle.upload_limit();
+    return (m_uploadLimit >= 0) ? m_uploadLimit : m_nativeHandle.upload_limit();
 }
 
 bool TorrentHandle::superSeeding() const
@@ -1792,6 +1796,14 @@ void TorrentHandle::handleSaveResumeDataAlert(const lt::save_resume_data_alert *
     resumeData["qBt-queuePosition"] = (static_cast<int>(nativeHandle().queue_position()) + 1); // qBt starts queue at 1
     resumeData["qBt-hasRootFolder"] = m_hasRootFolder;
 
+    // save the torrent's own limits instead of the ones of its bandwidth pools
+    if (m_poolLimits.downloadLimit > 0)
+        resumeData["download_rate_limit"] = m_downloadLimit;
+    if (m_poolLimits.uploadLimit > 0)
+        resumeData["upload_rate_limit"] = m_uploadLimit;
+    if (m_poolLimits.maxConnections > 0)
+        resumeData["max_connections"] = m_session->maxConnectionsPerTorrent();
+
     if (m_pauseWhenReady) {
         // We need to redefine these values when torrent starting/rechecking
         // in "paused" state since native values can be logically wrong
@@ -2150,12 +2162,62 @@ void TorrentHandle::setSeedingTimeLimit(int limit)
 
 void TorrentHandle::setUploadLimit(const int limit)
 {
-    m_nativeHandle.set_upload_limit(limit);
+    if (m_uploadLimit >= 0) {
+        m_uploadLimit = std::max(limit, 0);
+        m_nativeHandle.set_upload_limit(BandwidthPoolAllocator::combineLimits(m_uploadLimit, m_poolLimits.uploadLimit));
+    }
+    else {
+        m_nativeHandle.set_upload_limit(limit);
+    }
 }
 
 void TorrentHandle::setDownloadLimit(const int limit)
 {
-    m_nativeHandle.set_download_limit(limit);
+    if (m_downloadLimit >= 0) {
+        m_downloadLimit = std::max(limit, 0);
+        m_nativeHandle.set_download_limit(BandwidthPoolAllocator::combineLimits(m_downloadLimit, m_poolLimits.downloadLimit));
+    }
+    else {
+        m_nativeHandle.set_download_limit(limit);
+    }
+}
+
+void TorrentHandle::setPoolLimits(const BandwidthPoolLimits &limits)
+{
+    // Lowering a share is always applied, so that the shares of a pool never add up to more
+    // than its limit. Small raises aren't worth a call to libtorrent on every update.
+    const auto needsUpdate = [](const int current, const int share)
+    {
+        if ((current <= 0) || (share <= 0))
+            return (current != share);
+        return ((share < current) || ((share - current) > (current / 8)));
+    };
+
+    if (!limits.isEmpty()) {
+        if (m_downloadLimit < 0)
+            m_downloadLimit = std::max(m_nativeHandle.download_limit(), 0);
+        if (m_uploadLimit < 0)
+            m_uploadLimit = std::max(m_nativeHandle.upload_limit(), 0);
+    }
+
+    if (needsUpdate(m_poolLimits.downloadLimit, limits.downloadLimit)) {
+        m_poolLimits.downloadLimit = limits.downloadLimit;
+        m_nativeHandle.set_download_limit(BandwidthPoolAllocator::combineLimits(downloadLimit(), limits.downloadLimit));
+    }
+    if (needsUpdate(m_poolLimits.uploadLimit, limits.uploadLimit)) {
+        m_poolLimits.uploadLimit = limits.uploadLimit;
+        m_nativeHandle.set_upload_limit(BandwidthPoolAllocator::combineLimits(uploadLimit(), limits.uploadLimit));
+    }
+    if (m_poolLimits.maxConnections != limits.maxConnections) {
+        m_poolLimits.maxConnections = limits.maxConnections;
+        const int maxConnections = BandwidthPoolAllocator::combineLimits(m_session->maxConnectionsPerTorrent(), limits.maxConnections);
+        m_nativeHandle.set_max_connections((maxConnections > 0) ? maxConnections : -1);
+    }
+}
+
+BandwidthPoolLimits TorrentHandle::poolLimits() const
+{
+    return m_poolLimits;
 }
 
 void TorrentHandle::setSuperSeeding(const bool enable)
@@ -45,6 +45,7 @@
 #include <QVector>
 
 #include "private/speedmonitor.h"
+#include "bandwidthpool.h"
 #include "infohash.h"
 #include "torrentinfo.h"
 
@@ -323,6 +324,10 @@ namespace BitTorrent
         void setSeedingTimeLimit(int limit);
         void setUploadLimit(int limit);
         void setDownloadLimit(int limit);
+        // Shares of the bandwidth pools the torrent belongs to. They apply on top
+        // of the torrent's own limits and aren't saved in the resume data.
+        void setPoolLimits(const BandwidthPoolLimits &limits);
+        BandwidthPoolLimits poolLimits() const;
         void setSuperSeeding(bool enable);
         void flushCache();
         void addTrackers(const QVector<TrackerEntry> &trackers);
@@ -457,6 +462,11 @@ namespace BitTorrent
         bool m_pauseWhenReady;
 
         bool m_unchecked = false;
+
+        // own limits are kept aside once a pool limit is applied, -1 until then
+        int m_downloadLimit = -1;
+        int m_uploadLimit = -1;
+        BandwidthPoolLimits m_poolLimits;
     };
 }
 
@@ -38,6 +38,7 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -242,7 +243,14 @@ QStringList TorrentInfo::filePaths() const
 
 QString TorrentInfo::fileName(const int index) const
 {
+#if (LIBTORRENT_VERSION_NUM < 10200)
     return Utils::Fs::fileName(filePath(index));
+#else
+    // Convert only the name itself instead of building the whole path
+    if (!isValid()) return {};
+    const lt::string_view name = m_nativeInfo->files().file_name(LTFileIndex {index});
+    return QString::fromUtf8(name.data(), static_cast<int>(name.size()));
+#endif
 }
 
 QString TorrentInfo::origFilePath(const int index) const
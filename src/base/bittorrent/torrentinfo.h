@@ -115,4 +115,6 @@ namespace BitTorrent
     };
 }
 
+Q_DECLARE_METATYPE(BitTorrent::TorrentInfo)
+
 #endif // BITTORRENT_TORRENTINFO_H
@@ -33,7 +33,13 @@
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QHostAddress>
+#include <QSet>
+#include <QTimer>
+#include <QUdpSocket>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -42,18 +48,22 @@
 #include "base/http/types.h"
 #include "base/logger.h"
 #include "base/preferences.h"
+#include "base/utils/random.h"
 
 namespace
 {
     // static limits
-    const int MAX_TORRENTS = 10000;
-    const int MAX_PEERS_PER_TORRENT = 200;
     const int ANNOUNCE_INTERVAL = 1800;  // 30min
+    const int PEER_EXPIRY_TICK_INTERVAL = 60;  // 1min
+    const int PEER_EXPIRY_TICKS = (2 * ANNOUNCE_INTERVAL) / PEER_EXPIRY_TICK_INTERVAL;  // peers missing two announces are dropped
 
     // constants
     const int PEER_ID_SIZE = 20;
+    const int COMPACT_PEER_SIZE = 6;
+    const int COMPACT_PEER6_SIZE = 18;
 
     const char ANNOUNCE_REQUEST_PATH[] = "/announce";
+    const char SCRAPE_REQUEST_PATH[] = "/scrape";
 
     const char ANNOUNCE_REQUEST_COMPACT[] = "compact";
     const char ANNOUNCE_REQUEST_INFO_HASH[] = "info_hash";
@@ -83,6 +93,29 @@ namespace
     const char ANNOUNCE_RESPONSE_PEERS_PEER_ID[] = "peer id";
     const char ANNOUNCE_RESPONSE_PEERS_PORT[] = "port";
 
+    const char SCRAPE_RESPONSE_COMPLETE[] = "complete";
+    const char SCRAPE_RESPONSE_DOWNLOADED[] = "downloaded";
+    const char SCRAPE_RESPONSE_FILES[] = "files";
+    const char SCRAPE_RESPONSE_INCOMPLETE[] = "incomplete";
+
+    // [BEP-15] UDP Tracker Protocol
+    const quint64 UDP_PROTOCOL_ID = 0x41727101980;
+    const int UDP_CONNECTION_ID_LIFETIME = 60;  // seconds, the previous time slot is still accepted
+    const int UDP_MAX_DATAGRAM_SIZE = 1472;
+    const int UDP_MAX_SCRAPE_TORRENTS = 74;  // reply must fit in a single datagram
+    const int UDP_REQUEST_HEADER_SIZE = 16;
+    const int UDP_ANNOUNCE_REQUEST_SIZE = 98;
+
+    const quint32 UDP_ACTION_CONNECT = 0;
+    const quint32 UDP_ACTION_ANNOUNCE = 1;
+    const quint32 UDP_ACTION_SCRAPE = 2;
+    const quint32 UDP_ACTION_ERROR = 3;
+
+    const quint32 UDP_EVENT_NONE = 0;
+    const quint32 UDP_EVENT_COMPLETED = 1;
+    const quint32 UDP_EVENT_STARTED = 2;
+    const quint32 UDP_EVENT_STOPPED = 3;
+
     class TrackerError : public RuntimeError
     {
     public:
@@ -92,30 +125,50 @@ namespace
     QByteArray toBigEndianByteArray(const QHostAddress &addr)
     {
         // translate IP address to a sequence of bytes in big-endian order
-        switch (addr.protocol()) {
-        case QAbstractSocket::IPv4Protocol:
-        case QAbstractSocket::AnyIPProtocol: {
-                const quint32 ipv4 = addr.toIPv4Address();
-                QByteArray ret;
-                ret.append(static_cast<char>((ipv4 >> 24) & 0xFF))
-                   .append(static_cast<char>((ipv4 >> 16) & 0xFF))
-                   .append(static_cast<char>((ipv4 >> 8) & 0xFF))
-                   .append(static_cast<char>(ipv4 & 0xFF));
-                return ret;
-            }
+        // IPv4-mapped IPv6 addresses (as seen on dual-stack sockets) are treated as IPv4
+        bool isIPv4 = false;
+        const quint32 ipv4 = addr.toIPv4Address(&isIPv4);
+        if (isIPv4) {
+            QByteArray ret;
+            ret.append(static_cast<char>((ipv4 >> 24) & 0xFF))
+               .append(static_cast<char>((ipv4 >> 16) & 0xFF))
+               .append(static_cast<char>((ipv4 >> 8) & 0xFF))
+               .append(static_cast<char>(ipv4 & 0xFF));
+            return ret;
+        }
 
-        case QAbstractSocket::IPv6Protocol: {
-                const Q_IPV6ADDR ipv6 = addr.toIPv6Address();
-                QByteArray ret;
-                for (int i = (sizeof(ipv6.c) - 1); i >= 0; --i)
-                    ret.append(static_cast<char>(ipv6.c[i]));
-                return ret;
-            }
+        if (addr.protocol() == QAbstractSocket::IPv6Protocol) {
+            // Q_IPV6ADDR is already in network byte order
+            const Q_IPV6ADDR ipv6 = addr.toIPv6Address();
+            return QByteArray(reinterpret_cast<const char *>(ipv6.c), sizeof(ipv6.c));
+        }
 
-        case QAbstractSocket::UnknownNetworkLayerProtocol:
-        default:
-            return {};
-        };
+        return {};
+    }
+
+    QVector<int> sampleIndexes(const int count, const int size)
+    {
+        // Floyd's algorithm: `count` distinct random indexes in [0, size) in O(count)
+        QVector<int> ret;
+        ret.reserve(count);
+        QSet<int> selected;
+        selected.reserve(count);
+
+        for (int i = (size - count); i < size; ++i) {
+            const int candidate = static_cast<int>(Utils::Random::rand(0, i));
+            const int index = selected.contains(candidate) ? i : candidate;
+            selected.insert(index);
+            ret.append(index);
+        }
+
+        return ret;
+    }
+
+    QByteArray toCompactEndpoint(const QHostAddress &addr, const ushort port)
+    {
+        return toBigEndianByteArray(addr)
+            .append(static_cast<char>((port >> 8) & 0xFF))
+            .append(static_cast<char>(port & 0xFF));
     }
 }
 
@@ -156,47 +209,186 @@ struct Tracker::TrackerAnnounceRequest
     int numwant = 50;
     bool compact = true;
     bool noPeerId = false;
+
+    void cachePeerAddress();
 };
 
+void Tracker::TrackerAnnounceRequest::cachePeerAddress()
+{
+    // cache `peers` field so we don't recompute when sending response
+    const QHostAddress claimedIPAddress {QString::fromLatin1(claimedAddress)};
+    peer.endpoint = toCompactEndpoint((!claimedIPAddress.isNull() ? claimedIPAddress : socketAddress), peer.port)
+        .toStdString();
+
+    // cache `address` field so we don't recompute when sending response
+    peer.address = !claimedAddress.isEmpty()
+        ? claimedAddress.constData()
+        : socketAddress.toString().toLatin1().constData();
+}
+
 // Tracker::TorrentStats
-void Tracker::TorrentStats::setPeer(const Peer &peer)
+int Tracker::TorrentStats::seeders() const
+{
+    return (peerLists[IPv4Seeders].size() + peerLists[IPv6Seeders].size());
+}
+
+int Tracker::TorrentStats::leechers() const
+{
+    return (peerLists[IPv4Leechers].size() + peerLists[IPv6Leechers].size());
+}
+
+bool Tracker::TorrentStats::isEmpty() const
+{
+    return peerLocations.isEmpty();
+}
+
+void Tracker::TorrentStats::setPeer(const Peer &peer, const int maxPeers, const qint64 expiryTick)
 {
-    // always replace existing peer
-    if (!removePeer(peer)) {
+    // always replace existing peer, its seeding state might have changed
+    const QByteArray uniqueID = peer.uniqueID();
+    if (!removePeer(uniqueID)) {
         // Too many peers, remove a random one
-        if (peers.size() >= MAX_PEERS_PER_TORRENT)
-            removePeer(*peers.begin());
+        if (peerLocations.size() >= maxPeers) {
+            int index = static_cast<int>(Utils::Random::rand(0, (peerLocations.size() - 1)));
+            for (int list = 0; list < PeerListCount; ++list) {
+                if (index < peerLists[list].size()) {
+                    removePeerAt({list, index, 0});
+                    break;
+                }
+                index -= peerLists[list].size();
+            }
+        }
     }
 
     // add peer
-    if (peer.isSeeder)
-        ++seeders;
-    peers.insert(peer);
+    const int list = ((peer.endpoint.size() == COMPACT_PEER6_SIZE) ? IPv6Leechers : IPv4Leechers)
+        + (peer.isSeeder ? 1 : 0);
+    peerLists[list].append(peer);
+    peerLocations.insert(uniqueID, {list, (peerLists[list].size() - 1), expiryTick});
 }
 
-bool Tracker::TorrentStats::removePeer(const Peer &peer)
+bool Tracker::TorrentStats::removePeer(const QByteArray &uniqueID)
 {
-    const auto iter = peers.find(peer);
-    if (iter == peers.end())
+    const auto iter = peerLocations.constFind(uniqueID);
+    if (iter == peerLocations.cend())
         return false;
 
-    if (iter->isSeeder)
-        --seeders;
-    peers.remove(*iter);
+    removePeerAt(*iter);
+    return true;
+}
+
+bool Tracker::TorrentStats::expirePeer(const QByteArray &uniqueID, const qint64 tick)
+{
+    const auto iter = peerLocations.constFind(uniqueID);
+    if ((iter == peerLocations.cend()) || (iter->expiryTick > tick))
+        return false;  // gone already or announced again since
+
+    removePeerAt(*iter);
     return true;
 }
 
+void Tracker::TorrentStats::removePeerAt(const PeerLocation loc)
+{
+    // `loc` is taken by value since the entry it was copied from is removed below
+    QVector<Peer> &peers = peerLists[loc.list];
+
+    peerLocations.remove(peers[loc.index].uniqueID());
+
+    // swap with the last peer so the list stays dense
+    const int lastIndex = peers.size() - 1;
+    if (loc.index != lastIndex) {
+        peers[loc.index] = std::move(peers[lastIndex]);
+        peerLocations[peers[loc.index].uniqueID()].index = loc.index;
+    }
+    peers.removeLast();
+}
+
+QVector<const Peer *> Tracker::TorrentStats::samplePeers(const int count, const bool includeSeeders, const AddressFamily family) const
+{
+    QVector<const QVector<Peer> *> lists;
+    int total = 0;
+    for (int list = 0; list < PeerListCount; ++list) {
+        const bool isSeederList = ((list == IPv4Seeders) || (list == IPv6Seeders));
+        const bool isIPv6List = ((list == IPv6Leechers) || (list == IPv6Seeders));
+        if (isSeederList && !includeSeeders)
+            continue;
+        if (((family == AddressFamily::IPv4) && isIPv6List) || ((family == AddressFamily::IPv6) && !isIPv6List))
+            continue;
+
+        lists.append(&peerLists[list]);
+        total += peerLists[list].size();
+    }
+
+    const auto peerAt = [&lists](int index) -> const Peer *
+    {
+        for (const QVector<Peer> *peers : asConst(lists)) {
+            if (index < peers->size())
+                return &peers->at(index);
+            index -= peers->size();
+        }
+        return nullptr;
+    };
+
+    QVector<const Peer *> ret;
+    if (count >= total) {
+        ret.reserve(total);
+        for (int i = 0; i < total; ++i)
+            ret.append(peerAt(i));
+    }
+    else if (count > 0) {
+        ret.reserve(count);
+        for (const int index : asConst(sampleIndexes(count, total)))
+            ret.append(peerAt(index));
+    }
+
+    return ret;
+}
+
 // Tracker
 Tracker::Tracker(QObject *parent)
     : QObject(parent)
     , m_server(new Http::Server(this, this))
+    , m_udpSocket(new QUdpSocket(this))
+    , m_maxTorrents(Preferences::instance()->getTrackerMaxTorrents())
+    , m_maxPeersPerTorrent(Preferences::instance()->getTrackerMaxPeersPerTorrent())
+    , m_expiryTimer(new QTimer(this))
+    , m_expiryWheel(PEER_EXPIRY_TICKS + 1)
+    , m_currentTick(0)
 {
+    // secret used to sign UDP connection IDs, see udpConnectionId()
+    for (int i = 0; i < 4; ++i) {
+        const quint32 value = Utils::Random::rand();
+        m_udpConnectionSecret.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &Tracker::readPendingDatagrams);
+
+    m_expiryTimer->setInterval(PEER_EXPIRY_TICK_INTERVAL * 1000);
+    connect(m_expiryTimer, &QTimer::timeout, this, &Tracker::expirePeers);
+    m_expiryTimer->start();
 }
 
 bool Tracker::start()
 {
     const QHostAddress ip = QHostAddress::Any;
-    const int port = Preferences::instance()->getTrackerPort();
+    const Preferences *const pref = Preferences::instance();
+    const int port = pref->getTrackerPort();
+
+    m_maxTorrents = pref->getTrackerMaxTorrents();
+    m_maxPeersPerTorrent = pref->getTrackerMaxPeersPerTorrent();
+
+    if (m_udpSocket->state() == QAbstractSocket::BoundState) {
+        if (m_udpSocket->localPort() != port)
+            m_udpSocket->close();
+    }
+
+    if (m_udpSocket->state() != QAbstractSocket::BoundState) {
+        if (!m_udpSocket->bind(ip, port)) {
+            LogMsg(tr("Embedded Tracker: Unable to bind UDP socket to IP: %1, port: %2. Reason: %3")
+                    .arg(ip.toString(), QString::number(port), m_udpSocket->errorString())
+                , Log::WARNING);
+        }
+    }
 
     if (m_server->isListening()) {
         if (m_server->serverPort() == port) {
@@ -238,8 +430,11 @@ Http::Response Tracker::processRequest(const Http::Request &request, const Http:
         if (request.method != Http::HEADER_REQUEST_METHOD_GET)
             throw MethodNotAllowedHTTPError();
 
-        if (request.path.toLower().startsWith(ANNOUNCE_REQUEST_PATH))
+        const QString path = request.path.toLower();
+        if (path.startsWith(ANNOUNCE_REQUEST_PATH))
             processAnnounceRequest();
+        else if (path.startsWith(SCRAPE_REQUEST_PATH))
+            processScrapeRequest();
         else
             throw NotFoundHTTPError();
     }
@@ -323,19 +518,10 @@ void Tracker::processAnnounceRequest()
     // 7. compact
     announceReq.compact = (queryParams.value(ANNOUNCE_REQUEST_COMPACT) != "0");
 
-    // 8. cache `peers` field so we don't recompute when sending response
-    const QHostAddress claimedIPAddress {QString::fromLatin1(announceReq.claimedAddress)};
-    announceReq.peer.endpoint = toBigEndianByteArray(!claimedIPAddress.isNull() ? claimedIPAddress : announceReq.socketAddress)
-        .append(static_cast<char>((announceReq.peer.port >> 8) & 0xFF))
-        .append(static_cast<char>(announceReq.peer.port & 0xFF))
-        .toStdString();
-
-    // 9. cache `address` field so we don't recompute when sending response
-    announceReq.peer.address = !announceReq.claimedAddress.isEmpty()
-        ? announceReq.claimedAddress.constData()
-        : announceReq.socketAddress.toString().toLatin1().constData(),
+    // 8. cache `peers` & `address` fields so we don't recompute when sending response
+    announceReq.cachePeerAddress();
 
-    // 10. event
+    // 9. event
     announceReq.event = queryParams.value(ANNOUNCE_REQUEST_EVENT);
 
     if (announceReq.event.isEmpty()
@@ -359,11 +545,17 @@ void Tracker::registerPeer(const TrackerAnnounceRequest &announceReq)
 {
     if (!m_torrents.contains(announceReq.infoHash)) {
         // Reached max size, remove a random torrent
-        if (m_torrents.size() >= MAX_TORRENTS)
+        if (!m_torrents.isEmpty() && (m_torrents.size() >= m_maxTorrents))
             m_torrents.erase(m_torrents.begin());
     }
 
-    m_torrents[announceReq.infoHash].setPeer(announceReq.peer);
+    const qint64 expiryTick = m_currentTick + PEER_EXPIRY_TICKS;
+    TorrentStats &torrentStats = m_torrents[announceReq.infoHash];
+    torrentStats.setPeer(announceReq.peer, m_maxPeersPerTorrent, expiryTick);
+    m_expiryWheel[expiryTick % m_expiryWheel.size()].append({announceReq.infoHash, announceReq.peer.uniqueID()});
+
+    if (announceReq.event == ANNOUNCE_REQUEST_EVENT_COMPLETED)
+        ++torrentStats.downloaded;
 }
 
 void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
@@ -372,9 +564,9 @@ void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
     if (torrentStatsIter == m_torrents.end())
         return;
 
-    torrentStatsIter->removePeer(announceReq.peer);
+    torrentStatsIter->removePeer(announceReq.peer.uniqueID());
 
-    if (torrentStatsIter->peers.isEmpty())
+    if (torrentStatsIter->isEmpty())
         m_torrents.erase(torrentStatsIter);
 }
 
@@ -384,50 +576,45 @@ void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
 
     lt::entry::dictionary_type replyDict {
         {ANNOUNCE_RESPONSE_INTERVAL, ANNOUNCE_INTERVAL},
-        {ANNOUNCE_RESPONSE_COMPLETE, torrentStats.seeders},
-        {ANNOUNCE_RESPONSE_INCOMPLETE, (torrentStats.peers.size() - torrentStats.seeders)},
+        {ANNOUNCE_RESPONSE_COMPLETE, torrentStats.seeders()},
+        {ANNOUNCE_RESPONSE_INCOMPLETE, torrentStats.leechers()},
 
         // [BEP-24] Tracker Returns External IP
         {ANNOUNCE_RESPONSE_EXTERNAL_IP, toBigEndianByteArray(announceReq.socketAddress).toStdString()}
     };
 
-    // peer list
+    // peer list, randomly sampled so that clients don't all get the same subset of the swarm
+    // seeders are only useful to leechers
     // [BEP-7] IPv6 Tracker Extension (partial support)
     // [BEP-23] Tracker Returns Compact Peer Lists
-    if (announceReq.compact) {
-        lt::entry::list_type peerList;
-        lt::entry::list_type peer6List;
-
-        int counter = 0;
-        for (const Peer &peer : asConst(torrentStats.peers)) {
-            if (counter++ >= announceReq.numwant)
-                break;
+    const bool includeSeeders = !announceReq.peer.isSeeder;
 
-            if (peer.endpoint.size() == 6)  // IPv4
-                peerList.emplace_back(peer.endpoint);
-            else if (peer.endpoint.size() == 18)  // IPv6
-                peer6List.emplace_back(peer.endpoint);
+    if (announceReq.compact) {
+        // sample both address families together so that `numwant` covers the whole reply
+        QByteArray peers;
+        QByteArray peers6;
+        for (const Peer *peer : asConst(torrentStats.samplePeers(announceReq.numwant, includeSeeders))) {
+            if (peer->endpoint.size() == COMPACT_PEER6_SIZE)
+                peers6.append(peer->endpoint.data(), COMPACT_PEER6_SIZE);
+            else
+                peers.append(peer->endpoint.data(), COMPACT_PEER_SIZE);
         }
 
-        replyDict[ANNOUNCE_RESPONSE_PEERS] = peerList;  // required, even it's empty
-        if (!peer6List.empty())
-            replyDict[ANNOUNCE_RESPONSE_PEERS6] = peer6List;
+        replyDict[ANNOUNCE_RESPONSE_PEERS] = peers.toStdString();  // required, even it's empty
+        if (!peers6.isEmpty())
+            replyDict[ANNOUNCE_RESPONSE_PEERS6] = peers6.toStdString();
     }
     else {
         lt::entry::list_type peerList;
 
-        int counter = 0;
-        for (const Peer &peer : torrentStats.peers) {
-            if (counter++ >= announceReq.numwant)
-                break;
-
+        for (const Peer *peer : asConst(torrentStats.samplePeers(announceReq.numwant, includeSeeders))) {
             lt::entry::dictionary_type peerDict = {
-                {ANNOUNCE_RESPONSE_PEERS_IP, peer.address},
-                {ANNOUNCE_RESPONSE_PEERS_PORT, peer.port}
+                {ANNOUNCE_RESPONSE_PEERS_IP, peer->address},
+                {ANNOUNCE_RESPONSE_PEERS_PORT, peer->port}
             };
 
             if (!announceReq.noPeerId)
-                peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = peer.peerId.constData();
+                peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = peer->peerId.constData();
 
             peerList.emplace_back(peerDict);
         }
@@ -440,3 +627,257 @@ void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
     lt::bencode(std::back_inserter(reply), replyDict);
     print(reply, Http::CONTENT_TYPE_TXT);
 }
+
+void Tracker::processScrapeRequest()
+{
+    // [BEP-48] Tracker Protocol Extension: Scrape
+    lt::entry::dictionary_type files;
+
+    const auto addTorrent = [&files](const InfoHash &infoHash, const TorrentStats &torrentStats)
+    {
+        const lt::entry::dictionary_type torrentDict {
+            {SCRAPE_RESPONSE_COMPLETE, torrentStats.seeders()},
+            {SCRAPE_RESPONSE_DOWNLOADED, torrentStats.downloaded},
+            {SCRAPE_RESPONSE_INCOMPLETE, torrentStats.leechers()}
+        };
+        files[static_cast<lt::sha1_hash>(infoHash).to_string()] = torrentDict;
+    };
+
+    // several `info_hash` parameters can be given
+    const QList<QByteArray> infoHashes = m_request.query.values(ANNOUNCE_REQUEST_INFO_HASH);
+    if (!infoHashes.isEmpty()) {
+        for (const QByteArray &infoHashData : infoHashes) {
+            const InfoHash infoHash(infoHashData.toHex());
+            if (!infoHash.isValid())
+                throw TrackerError("Invalid \"info_hash\" parameter");
+
+            const auto torrentStatsIter = m_torrents.constFind(infoHash);
+            if (torrentStatsIter != m_torrents.cend())
+                addTorrent(infoHash, *torrentStatsIter);
+        }
+    }
+    else {
+        // no `info_hash` given, scrape all torrents
+        for (auto iter = m_torrents.cbegin(); iter != m_torrents.cend(); ++iter)
+            addTorrent(iter.key(), iter.value());
+    }
+
+    const lt::entry::dictionary_type replyDict {
+        {SCRAPE_RESPONSE_FILES, files}
+    };
+
+    // bencode
+    QByteArray reply;
+    lt::bencode(std::back_inserter(reply), replyDict);
+    print(reply, Http::CONTENT_TYPE_TXT);
+}
+
+void Tracker::expirePeers()
+{
+    ++m_currentTick;
+
+    QVector<ExpiryEntry> &slot = m_expiryWheel[m_currentTick % m_expiryWheel.size()];
+    for (const ExpiryEntry &entry : asConst(slot)) {
+        // entries of peers that announced again since are stale and skipped by `expirePeer()`
+        const auto torrentStatsIter = m_torrents.find(entry.infoHash);
+        if (torrentStatsIter == m_torrents.end())
+            continue;
+
+        if (torrentStatsIter->expirePeer(entry.peerUniqueID, m_currentTick) && torrentStatsIter->isEmpty())
+            m_torrents.erase(torrentStatsIter);
+    }
+    slot.clear();
+}
+
+void Tracker::readPendingDatagrams()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        QByteArray datagram;
+        datagram.resize(static_cast<int>(m_udpSocket->pendingDatagramSize()));
+
+        QHostAddress address;
+        quint16 port = 0;
+        if (m_udpSocket->readDatagram(datagram.data(), datagram.size(), &address, &port) < 0)
+            continue;
+
+        const QByteArray reply = processUdpRequest(datagram, address, port);
+        if (!reply.isEmpty())
+            m_udpSocket->writeDatagram(reply, address, port);
+    }
+}
+
+QByteArray Tracker::processUdpRequest(const QByteArray &datagram, const QHostAddress &address, const quint16 port)
+{
+    // [BEP-15] UDP Tracker Protocol for BitTorrent
+    if (datagram.size() < UDP_REQUEST_HEADER_SIZE)
+        return {};  // malformed request, ignore it
+
+    QDataStream in(datagram);
+    quint64 connectionId = 0;
+    quint32 action = 0;
+    quint32 transactionId = 0;
+    in >> connectionId >> action >> transactionId;
+
+    const qint64 timeSlot = QDateTime::currentMSecsSinceEpoch() / 1000 / UDP_CONNECTION_ID_LIFETIME;
+
+    try {
+        if (action == UDP_ACTION_CONNECT) {
+            if (connectionId != UDP_PROTOCOL_ID)
+                return {};
+
+            QByteArray reply;
+            QDataStream out(&reply, QIODevice::WriteOnly);
+            out << UDP_ACTION_CONNECT << transactionId << udpConnectionId(address, port, timeSlot);
+            return reply;
+        }
+
+        // connection IDs are stateless, accept the ones issued in the current and previous time slot
+        if ((connectionId != udpConnectionId(address, port, timeSlot))
+            && (connectionId != udpConnectionId(address, port, (timeSlot - 1)))) {
+            throw TrackerError("Invalid connection ID");
+        }
+
+        if (action == UDP_ACTION_ANNOUNCE)
+            return processUdpAnnounceRequest(datagram, address, transactionId);
+        if (action == UDP_ACTION_SCRAPE)
+            return processUdpScrapeRequest(datagram, transactionId);
+
+        throw TrackerError("Invalid action");
+    }
+    catch (const TrackerError &error) {
+        QByteArray reply;
+        QDataStream out(&reply, QIODevice::WriteOnly);
+        out << UDP_ACTION_ERROR << transactionId;
+        reply.append(error.what());
+        return reply;
+    }
+}
+
+QByteArray Tracker::processUdpAnnounceRequest(const QByteArray &datagram, const QHostAddress &address, const quint32 transactionId)
+{
+    if (datagram.size() < UDP_ANNOUNCE_REQUEST_SIZE)
+        throw TrackerError("Malformed announce request");
+
+    QDataStream in(datagram);
+    in.skipRawData(UDP_REQUEST_HEADER_SIZE);
+
+    QByteArray infoHashData(InfoHash::length(), Qt::Uninitialized);
+    in.readRawData(infoHashData.data(), infoHashData.size());
+    QByteArray peerId(PEER_ID_SIZE, Qt::Uninitialized);
+    in.readRawData(peerId.data(), peerId.size());
+
+    quint64 downloaded = 0;
+    quint64 left = 0;
+    quint64 uploaded = 0;
+    quint32 event = 0;
+    quint32 ipv4 = 0;
+    quint32 key = 0;
+    qint32 numWant = 0;
+    quint16 peerPort = 0;
+    in >> downloaded >> left >> uploaded >> event >> ipv4 >> key >> numWant >> peerPort;
+
+    TrackerAnnounceRequest announceReq;
+    announceReq.socketAddress = address;
+    if (ipv4 != 0)
+        announceReq.claimedAddress = QHostAddress(ipv4).toString().toLatin1();
+
+    announceReq.infoHash = InfoHash(infoHashData.toHex());
+    if (!announceReq.infoHash.isValid())
+        throw TrackerError("Invalid info hash");
+
+    announceReq.peer.peerId = peerId;
+
+    if (peerPort == 0)
+        throw TrackerError("Invalid port");
+    announceReq.peer.port = peerPort;
+
+    if (numWant >= 0)  // -1 means default
+        announceReq.numwant = numWant;
+
+    announceReq.peer.isSeeder = (left == 0);
+    announceReq.cachePeerAddress();
+
+    switch (event) {
+    case UDP_EVENT_NONE:
+        break;
+    case UDP_EVENT_COMPLETED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_COMPLETED;
+        break;
+    case UDP_EVENT_STARTED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_STARTED;
+        break;
+    case UDP_EVENT_STOPPED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_STOPPED;
+        break;
+    default:
+        throw TrackerError("Invalid event");
+    }
+
+    if (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED)
+        unregisterPeer(announceReq);
+    else
+        registerPeer(announceReq);
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+
+    const auto torrentStatsIter = m_torrents.constFind(announceReq.infoHash);
+    if (torrentStatsIter == m_torrents.cend()) {
+        out << UDP_ACTION_ANNOUNCE << transactionId << quint32(ANNOUNCE_INTERVAL) << quint32(0) << quint32(0);
+        return reply;
+    }
+
+    const TorrentStats &torrentStats = *torrentStatsIter;
+    out << UDP_ACTION_ANNOUNCE << transactionId << quint32(ANNOUNCE_INTERVAL)
+        << quint32(torrentStats.leechers())
+        << quint32(torrentStats.seeders());
+
+    if (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED)
+        return reply;
+
+    // the address family of the peer list is implied by the one the request came from
+    const bool isIPv4 = (toBigEndianByteArray(address).size() == 4);
+    const int peerSize = isIPv4 ? COMPACT_PEER_SIZE : COMPACT_PEER6_SIZE;
+    const int maxPeers = qMin(announceReq.numwant, ((UDP_MAX_DATAGRAM_SIZE - reply.size()) / peerSize));
+    const QVector<const Peer *> peers = torrentStats.samplePeers(maxPeers, !announceReq.peer.isSeeder
+        , (isIPv4 ? TorrentStats::AddressFamily::IPv4 : TorrentStats::AddressFamily::IPv6));
+    for (const Peer *peer : peers)
+        reply.append(peer->endpoint.data(), peerSize);
+    return reply;
+}
+
+QByteArray Tracker::processUdpScrapeRequest(const QByteArray &datagram, const quint32 transactionId)
+{
+    const int hashSize = InfoHash::length();
+    const int count = qMin(((datagram.size() - UDP_REQUEST_HEADER_SIZE) / hashSize), UDP_MAX_SCRAPE_TORRENTS);
+    if (count <= 0)
+        throw TrackerError("Malformed scrape request");
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out << UDP_ACTION_SCRAPE << transactionId;
+
+    for (int i = 0; i < count; ++i) {
+        const int offset = UDP_REQUEST_HEADER_SIZE + (i * hashSize);
+        const InfoHash infoHash(datagram.mid(offset, hashSize).toHex());
+
+        const TorrentStats torrentStats = m_torrents.value(infoHash);
+        out << quint32(torrentStats.seeders()) << quint32(torrentStats.downloaded)
+            << quint32(torrentStats.leechers());
+    }
+
+    return reply;
+}
+
+quint64 Tracker::udpConnectionId(const QHostAddress &address, const quint16 port, const qint64 timeSlot) const
+{
+    QByteArray data = m_udpConnectionSecret;
+    data.append(toBigEndianByteArray(address));
+    data.append(QByteArray::number(port));
+    data.append(QByteArray::number(timeSlot));
+
+    quint64 connectionId = 0;
+    QDataStream in(QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+    in >> connectionId;
+    return connectionId;
+}
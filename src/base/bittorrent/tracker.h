@@ -37,12 +37,16 @@
 
 #include <QHash>
 #include <QObject>
-#include <QSet>
+#include <QVector>
 
 #include "base/bittorrent/infohash.h"
 #include "base/http/irequesthandler.h"
 #include "base/http/responsebuilder.h"
 
+class QHostAddress;
+class QTimer;
+class QUdpSocket;
+
 namespace Http
 {
     class Server;
@@ -69,6 +73,8 @@ namespace BitTorrent
 
     // *Basic* Bittorrent tracker implementation
     // [BEP-3] The BitTorrent Protocol Specification
+    // [BEP-15] UDP Tracker Protocol for BitTorrent
+    // [BEP-48] Tracker Protocol Extension: Scrape
     // also see: https://wiki.theory.org/index.php/BitTorrentSpecification#Tracker_HTTP.2FHTTPS_Protocol
     class Tracker : public QObject, public Http::IRequestHandler, private Http::ResponseBuilder
     {
@@ -79,11 +85,53 @@ namespace BitTorrent
 
         struct TorrentStats
         {
-            qint64 seeders = 0;
-            QSet<Peer> peers;
+            // Peers are kept in dense lists (one per address family and seeding state) so that
+            // they can be sampled randomly and removed in O(1) by swapping with the last one
+            enum PeerListType
+            {
+                IPv4Leechers,
+                IPv4Seeders,
+                IPv6Leechers,
+                IPv6Seeders,
+
+                PeerListCount
+            };
+
+            enum class AddressFamily
+            {
+                Any,
+                IPv4,
+                IPv6
+            };
+
+            struct PeerLocation
+            {
+                int list = 0;
+                int index = 0;
+                qint64 expiryTick = 0;
+            };
+
+            QVector<Peer> peerLists[PeerListCount];
+            QHash<QByteArray, PeerLocation> peerLocations;  // key: Peer::uniqueID()
+            qint64 downloaded = 0;
+
+            int seeders() const;
+            int leechers() const;
+            bool isEmpty() const;
+
+            void setPeer(const Peer &peer, int maxPeers, qint64 expiryTick);
+            bool removePeer(const QByteArray &uniqueID);
+            bool expirePeer(const QByteArray &uniqueID, qint64 tick);
+            QVector<const Peer *> samplePeers(int count, bool includeSeeders, AddressFamily family = AddressFamily::Any) const;
+
+        private:
+            void removePeerAt(PeerLocation loc);
+        };
 
-            void setPeer(const Peer &peer);
-            bool removePeer(const Peer &peer);
+        struct ExpiryEntry
+        {
+            InfoHash infoHash;
+            QByteArray peerUniqueID;
         };
 
     public:
@@ -91,9 +139,19 @@ namespace BitTorrent
 
         bool start();
 
+    private slots:
+        void readPendingDatagrams();
+        void expirePeers();
+
     private:
         Http::Response processRequest(const Http::Request &request, const Http::Environment &env) override;
         void processAnnounceRequest();
+        void processScrapeRequest();
+
+        QByteArray processUdpRequest(const QByteArray &datagram, const QHostAddress &address, quint16 port);
+        QByteArray processUdpAnnounceRequest(const QByteArray &datagram, const QHostAddress &address, quint32 transactionId);
+        QByteArray processUdpScrapeRequest(const QByteArray &datagram, quint32 transactionId);
+        quint64 udpConnectionId(const QHostAddress &address, quint16 port, qint64 timeSlot) const;
 
         void registerPeer(const TrackerAnnounceRequest &announceReq);
         void unregisterPeer(const TrackerAnnounceRequest &announceReq);
@@ -103,7 +161,18 @@ namespace BitTorrent
         Http::Request m_request;
         Http::Environment m_env;
 
+        QUdpSocket *m_udpSocket;
+        QByteArray m_udpConnectionSecret;
+
+        int m_maxTorrents;
+        int m_maxPeersPerTorrent;
+
         QHash<InfoHash, TorrentStats> m_torrents;
+
+        // timing wheel for peer expiry, each slot holds the peers due to expire at that tick
+        QTimer *m_expiryTimer;
+        QVector<QVector<ExpiryEntry>> m_expiryWheel;
+        qint64 m_currentTick;
     };
 }
 
@@ -0,0 +1,418 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "traffichistory.h"
+
+#include <algorithm>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QThread>
+#include <QUrl>
+
+#include "base/asyncfilestorage.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+#include "torrenthandle.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const char STORAGE_FOLDER[] = "TrafficHistory";
+    const QString SNAPSHOT_FILE = QStringLiteral("history.dat");
+    const QString JOURNAL_FILE = QStringLiteral("history.journal");
+    const quint32 FORMAT_VERSION = 1;
+    const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_9;
+
+    const int FLUSH_INTERVAL = 60 * 1000; // 1 min
+    const qint64 MAX_JOURNAL_SIZE = 8 * 1024 * 1024;
+    const int MAX_SERIES_PER_TYPE = 5000;
+
+    const qint64 HOUR = 60 * 60;
+    const qint64 DAY = 24 * HOUR;
+
+    const qint64 TIER_RESOLUTION[] = {60, HOUR, DAY};
+    // How long the buckets are kept, per series type and tier.
+    // Torrents have no minute tier and shorter ones since there can be many of them.
+    const qint64 TIER_RETENTION[][3] = {
+        {2 * DAY, 90 * DAY, 5 * 365 * DAY}, // Global
+        {0, 7 * DAY, 365 * DAY}, // Torrent
+        {DAY, 90 * DAY, 5 * 365 * DAY}, // Category
+        {DAY, 90 * DAY, 5 * 365 * DAY} // Tracker
+    };
+
+    auto timestampLess = [](const TrafficSample &sample, const qint64 timestamp)
+    {
+        return (sample.timestamp < timestamp);
+    };
+
+    void addSample(QVector<TrafficSample> &samples, const qint64 resolution, const qint64 retention
+                   , const qint64 time, const qint64 downloaded, const qint64 uploaded)
+    {
+        const qint64 bucket = time - (time % resolution);
+
+        if (!samples.isEmpty() && (samples.last().timestamp >= bucket)) {
+            // Samples are recorded in time order, the previous ones
+            // can only be updated when an old journal is replayed
+            const auto iter = std::lower_bound(samples.begin(), samples.end(), bucket, timestampLess);
+            if (iter->timestamp == bucket) {
+                iter->downloaded += downloaded;
+                iter->uploaded += uploaded;
+            }
+            else {
+                samples.insert(iter, {bucket, downloaded, uploaded});
+            }
+            return;
+        }
+
+        samples.append({bucket, downloaded, uploaded});
+
+        const auto firstKept = std::lower_bound(samples.begin(), samples.end(), (bucket - retention), timestampLess);
+        if (firstKept != samples.begin())
+            samples.erase(samples.begin(), firstKept);
+    }
+
+    void writeSeriesSamples(QDataStream &stream, const QVector<TrafficSample> &samples)
+    {
+        stream << static_cast<quint32>(samples.size());
+        for (const TrafficSample &sample : samples)
+            stream << sample.timestamp << sample.downloaded << sample.uploaded;
+    }
+
+    bool readSeriesSamples(QDataStream &stream, QVector<TrafficSample> &samples)
+    {
+        quint32 count = 0;
+        stream >> count;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+
+        samples.reserve(static_cast<int>(count));
+        for (quint32 i = 0; i < count; ++i) {
+            TrafficSample sample;
+            stream >> sample.timestamp >> sample.downloaded >> sample.uploaded;
+            if (stream.status() != QDataStream::Ok)
+                return false;
+            samples.append(sample);
+        }
+        return true;
+    }
+
+    QByteArray journalHeader(const quint32 generation)
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(STREAM_VERSION);
+        stream << FORMAT_VERSION << generation;
+        return data;
+    }
+}
+
+TrafficHistory::TrafficHistory(QObject *parent)
+    : QObject(parent)
+    , m_ioThread(new QThread(this))
+    , m_generation(0)
+    , m_journalSize(0)
+{
+    m_storage = new AsyncFileStorage(
+                Utils::Fs::expandPathAbs(specialFolderLocation(SpecialFolder::Data) + STORAGE_FOLDER));
+    m_storage->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_storage, &AsyncFileStorage::deleteLater);
+    connect(m_storage, &AsyncFileStorage::failed, [](const QString &fileName, const QString &errorString)
+    {
+        LogMsg(tr("Couldn't save traffic history in %1. Error: %2")
+               .arg(fileName, errorString), Log::WARNING);
+    });
+    m_ioThread->start();
+
+    load();
+
+    connect(&m_flushTimer, &QTimer::timeout, this, &TrafficHistory::flushJournal);
+    m_flushTimer.start(FLUSH_INTERVAL);
+}
+
+TrafficHistory::~TrafficHistory()
+{
+    flushJournal();
+    compact();
+
+    m_ioThread->quit();
+    m_ioThread->wait();
+}
+
+void TrafficHistory::update(const QVector<TorrentHandle *> &torrents)
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    for (const TorrentHandle *torrent : torrents) {
+        const Totals totals {torrent->totalDownload(), torrent->totalUpload()};
+
+        const auto iter = m_lastTotals.find(torrent->hash());
+        if (iter == m_lastTotals.end()) {
+            // the counters are restored from the resume data, only the later changes are counted
+            m_lastTotals.insert(torrent->hash(), totals);
+            continue;
+        }
+
+        const qint64 downloaded = std::max<qint64>(0, (totals.downloaded - iter->downloaded));
+        const qint64 uploaded = std::max<qint64>(0, (totals.uploaded - iter->uploaded));
+        *iter = totals;
+        if ((downloaded == 0) && (uploaded == 0))
+            continue;
+
+        const QString category = torrent->category();
+        const QString tracker = QUrl(torrent->currentTracker()).host();
+        apply(now, torrent->hash(), category, tracker, downloaded, uploaded);
+
+        // The journal gets at most one record per torrent and flush interval
+        auto recordIter = m_pendingRecords.find(torrent->hash());
+        if (recordIter == m_pendingRecords.end())
+            recordIter = m_pendingRecords.insert(torrent->hash(), {now, category, tracker, 0, 0});
+        recordIter->category = category;
+        recordIter->tracker = tracker;
+        recordIter->downloaded += downloaded;
+        recordIter->uploaded += uploaded;
+    }
+}
+
+void TrafficHistory::forgetTorrent(const InfoHash &hash)
+{
+    m_lastTotals.remove(hash);
+}
+
+QStringList TrafficHistory::seriesIDs(const SeriesType type) const
+{
+    return m_series[static_cast<int>(type)].keys();
+}
+
+QVector<TrafficSample> TrafficHistory::query(const SeriesType type, const QString &id
+                                             , const qint64 from, const qint64 to, qint64 step) const
+{
+    const int typeIndex = static_cast<int>(type);
+    const auto seriesIter = m_series[typeIndex].constFind(id);
+    if (seriesIter == m_series[typeIndex].cend())
+        return {};
+
+    // Use the finest tier that still covers the requested range,
+    // the step can't be finer than its resolution
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    int tier = DayTier;
+    for (int i = MinuteTier; i < TierCount; ++i) {
+        const qint64 retention = TIER_RETENTION[typeIndex][i];
+        if ((retention > 0) && (from >= (now - retention))) {
+            tier = i;
+            break;
+        }
+    }
+    step = std::max(step, TIER_RESOLUTION[tier]);
+
+    QVector<TrafficSample> result;
+    const QVector<TrafficSample> &samples = seriesIter->tiers[tier];
+    auto iter = std::lower_bound(samples.cbegin(), samples.cend(), (from - (from % TIER_RESOLUTION[tier])), timestampLess);
+    for (; (iter != samples.cend()) && (iter->timestamp < to); ++iter) {
+        const qint64 period = iter->timestamp - (iter->timestamp % step);
+        if (result.isEmpty() || (result.last().timestamp != period))
+            result.append({period, 0, 0});
+        result.last().downloaded += iter->downloaded;
+        result.last().uploaded += iter->uploaded;
+    }
+
+    return result;
+}
+
+void TrafficHistory::flushJournal()
+{
+    if (m_pendingRecords.isEmpty())
+        return;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+    for (auto iter = m_pendingRecords.cbegin(); iter != m_pendingRecords.cend(); ++iter) {
+        stream << iter->timestamp << QString(iter.key()) << iter->category << iter->tracker
+               << iter->downloaded << iter->uploaded;
+    }
+    m_pendingRecords.clear();
+
+    m_storage->append(JOURNAL_FILE, data);
+    m_journalSize += data.size();
+    if (m_journalSize > MAX_JOURNAL_SIZE)
+        compact();
+}
+
+void TrafficHistory::load()
+{
+    const QDir storageDir = m_storage->storageDir();
+
+    QFile snapshotFile(storageDir.absoluteFilePath(SNAPSHOT_FILE));
+    if (snapshotFile.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&snapshotFile);
+        stream.setVersion(STREAM_VERSION);
+
+        quint32 version = 0;
+        quint32 generation = 0;
+        stream >> version >> generation;
+        if (version == FORMAT_VERSION) {
+            m_generation = generation;
+            for (int typeIndex = 0; typeIndex < SeriesTypeCount; ++typeIndex) {
+                QHash<QString, Series> &series = m_series[typeIndex];
+                quint32 count = 0;
+                stream >> count;
+                for (quint32 i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i) {
+                    QString id;
+                    Series item;
+                    stream >> id >> item.lastUpdate;
+                    for (QVector<TrafficSample> &samples : item.tiers) {
+                        if (!readSeriesSamples(stream, samples))
+                            break;
+                    }
+                    if (stream.status() == QDataStream::Ok)
+                        series.insert(id, item);
+                }
+
+                // Restore the eviction order
+                QStringList ids = series.keys();
+                std::sort(ids.begin(), ids.end(), [&series](const QString &left, const QString &right)
+                {
+                    return (series[left].lastUpdate < series[right].lastUpdate);
+                });
+                std::list<QString> &recentlyUpdated = m_recentlyUpdated[typeIndex];
+                for (const QString &id : asConst(ids))
+                    series[id].recentPos = recentlyUpdated.insert(recentlyUpdated.end(), id);
+            }
+        }
+
+        if (stream.status() != QDataStream::Ok)
+            LogMsg(tr("Traffic history file is corrupted, some of the history may be lost."), Log::WARNING);
+    }
+
+    QFile journalFile(storageDir.absoluteFilePath(JOURNAL_FILE));
+    if (journalFile.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&journalFile);
+        stream.setVersion(STREAM_VERSION);
+
+        quint32 version = 0;
+        quint32 generation = 0;
+        stream >> version >> generation;
+        // Journals of older generations were already folded into the snapshot
+        if ((version == FORMAT_VERSION) && (generation == m_generation)) {
+            while (!stream.atEnd()) {
+                qint64 timestamp = 0;
+                QString torrentID;
+                QString category;
+                QString tracker;
+                qint64 downloaded = 0;
+                qint64 uploaded = 0;
+                stream >> timestamp >> torrentID >> category >> tracker >> downloaded >> uploaded;
+                if (stream.status() != QDataStream::Ok)
+                    break; // the last record may be incomplete after a crash
+
+                apply(timestamp, torrentID, category, tracker, downloaded, uploaded);
+            }
+        }
+    }
+
+    compact();
+}
+
+void TrafficHistory::compact()
+{
+    // The journal is reset with the new generation so that it isn't replayed
+    // again over the new snapshot, even if the program exits in between
+    ++m_generation;
+    // The series are implicitly shared, so they are serialized in the I/O thread from a cheap copy
+    m_storage->store(SNAPSHOT_FILE, [generation = m_generation, seriesMaps = m_series]()
+    {
+        return snapshot(generation, seriesMaps);
+    });
+
+    const QByteArray header = journalHeader(m_generation);
+    m_storage->store(JOURNAL_FILE, header);
+    m_journalSize = header.size();
+}
+
+void TrafficHistory::apply(const qint64 time, const QString &torrentID, const QString &category, const QString &tracker
+                           , const qint64 downloaded, const qint64 uploaded)
+{
+    record(SeriesType::Global, {}, time, downloaded, uploaded);
+    record(SeriesType::Torrent, torrentID, time, downloaded, uploaded);
+    record(SeriesType::Category, category, time, downloaded, uploaded);
+    if (!tracker.isEmpty())
+        record(SeriesType::Tracker, tracker, time, downloaded, uploaded);
+}
+
+void TrafficHistory::record(const SeriesType type, const QString &id, const qint64 time
+                            , const qint64 downloaded, const qint64 uploaded)
+{
+    const int typeIndex = static_cast<int>(type);
+    QHash<QString, Series> &series = m_series[typeIndex];
+    std::list<QString> &recentlyUpdated = m_recentlyUpdated[typeIndex];
+
+    auto iter = series.find(id);
+    if (iter == series.end()) {
+        // Forget the series which weren't updated for the longest time to keep the memory bounded
+        if (series.size() >= MAX_SERIES_PER_TYPE) {
+            series.remove(recentlyUpdated.front());
+            recentlyUpdated.pop_front();
+        }
+        iter = series.insert(id, {});
+        iter->recentPos = recentlyUpdated.insert(recentlyUpdated.end(), id);
+    }
+    else {
+        recentlyUpdated.splice(recentlyUpdated.end(), recentlyUpdated, iter->recentPos);
+    }
+
+    iter->lastUpdate = std::max(iter->lastUpdate, time);
+    for (int i = MinuteTier; i < TierCount; ++i) {
+        const qint64 retention = TIER_RETENTION[typeIndex][i];
+        if (retention > 0)
+            addSample(iter->tiers[i], TIER_RESOLUTION[i], retention, time, downloaded, uploaded);
+    }
+}
+
+QByteArray TrafficHistory::snapshot(const quint32 generation, const SeriesMaps &seriesMaps)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+
+    stream << FORMAT_VERSION << generation;
+    for (const QHash<QString, Series> &series : seriesMaps) {
+        stream << static_cast<quint32>(series.size());
+        for (auto iter = series.cbegin(); iter != series.cend(); ++iter) {
+            stream << iter.key() << iter->lastUpdate;
+            for (const QVector<TrafficSample> &samples : iter->tiers)
+                writeSeriesSamples(stream, samples);
+        }
+    }
+
+    return data;
+}
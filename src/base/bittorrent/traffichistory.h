@@ -0,0 +1,143 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <list>
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "infohash.h"
+
+class QThread;
+class AsyncFileStorage;
+
+namespace BitTorrent
+{
+    class TorrentHandle;
+
+    struct TrafficSample
+    {
+        qint64 timestamp = 0; // secs since epoch, start of the sampled period
+        qint64 downloaded = 0;
+        qint64 uploaded = 0;
+    };
+
+    // Keeps the amount of transferred data over time for the whole session and per torrent,
+    // category and tracker. The transfers are summed up into minute, hour and day buckets which
+    // are kept for a limited time, and only non-empty buckets are stored.
+    // On disk the history is a snapshot plus a journal of the later transfers which is
+    // appended to once a minute and folded into a new snapshot when it grows too large.
+    class TrafficHistory : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TrafficHistory)
+
+    public:
+        enum class SeriesType
+        {
+            Global,
+            Torrent,
+            Category,
+            Tracker
+        };
+
+        explicit TrafficHistory(QObject *parent = nullptr);
+        ~TrafficHistory() override;
+
+        void update(const QVector<TorrentHandle *> &torrents);
+        void forgetTorrent(const InfoHash &hash);
+
+        QStringList seriesIDs(SeriesType type) const;
+        // Sums up the transfers of [from, to) into `step` seconds long periods, empty periods are omitted.
+        // The period can get longer if the transfers aren't kept with that precision.
+        QVector<TrafficSample> query(SeriesType type, const QString &id, qint64 from, qint64 to, qint64 step) const;
+
+    private slots:
+        void flushJournal();
+
+    private:
+        enum Tier
+        {
+            MinuteTier,
+            HourTier,
+            DayTier,
+
+            TierCount
+        };
+
+        static const int SeriesTypeCount = 4;
+
+        struct Series
+        {
+            std::array<QVector<TrafficSample>, TierCount> tiers;
+            qint64 lastUpdate = 0;
+            std::list<QString>::iterator recentPos; // position in m_recentlyUpdated
+        };
+
+        using SeriesMaps = std::array<QHash<QString, Series>, SeriesTypeCount>;
+
+        struct Totals
+        {
+            qint64 downloaded;
+            qint64 uploaded;
+        };
+
+        struct JournalRecord
+        {
+            qint64 timestamp;
+            QString category;
+            QString tracker;
+            qint64 downloaded;
+            qint64 uploaded;
+        };
+
+        void load();
+        void compact();
+        void apply(qint64 time, const QString &torrentID, const QString &category, const QString &tracker
+                   , qint64 downloaded, qint64 uploaded);
+        void record(SeriesType type, const QString &id, qint64 time, qint64 downloaded, qint64 uploaded);
+        static QByteArray snapshot(quint32 generation, const SeriesMaps &seriesMaps);
+
+        QThread *m_ioThread;
+        AsyncFileStorage *m_storage;
+
+        SeriesMaps m_series;
+        // The series IDs from the least to the most recently updated, for evicting the stale ones
+        std::array<std::list<QString>, SeriesTypeCount> m_recentlyUpdated;
+        QHash<InfoHash, Totals> m_lastTotals;
+        QHash<InfoHash, JournalRecord> m_pendingRecords;
+        quint32 m_generation;
+        qint64 m_journalSize;
+        QTimer m_flushTimer;
+    };
+}
@@ -36,20 +36,46 @@
 #include <sys/param.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QThread>
+
 #include "base/algorithm.h"
 #include "base/bittorrent/torrentinfo.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
+#include "private/filesystemwatcher_p.h"
 
 namespace
 {
     const int WATCH_INTERVAL = 10000; // 10 sec
     const int MAX_PARTIAL_RETRIES = 5;
+
+    bool isMagnetFile(const QString &path)
+    {
+        return path.endsWith(QLatin1String(".magnet"));
+    }
+
+    bool isWatchedFile(const QString &path)
+    {
+        return (path.endsWith(QLatin1String(".torrent")) || isMagnetFile(path));
+    }
 }
 
 FileSystemWatcher::FileSystemWatcher(QObject *parent)
     : QFileSystemWatcher(parent)
+    , m_parserThread(new QThread(this))
+    , m_parser(new Private::TorrentFileParser)
+#ifdef Q_OS_LINUX
+    , m_inotifyFD(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    , m_inotifyNotifier(nullptr)
+#endif
 {
     connect(this, &QFileSystemWatcher::directoryChanged, this, &FileSystemWatcher::scanLocalFolder);
 
@@ -57,11 +83,44 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent)
     connect(&m_partialTorrentTimer, &QTimer::timeout, this, &FileSystemWatcher::processPartialTorrents);
 
     connect(&m_watchTimer, &QTimer::timeout, this, &FileSystemWatcher::scanNetworkFolders);
+
+    qRegisterMetaType<BitTorrent::TorrentInfo>();
+    m_parser->moveToThread(m_parserThread);
+    connect(m_parserThread, &QThread::finished, m_parser, &QObject::deleteLater);
+    connect(m_parser, &Private::TorrentFileParser::torrentParsed, this, &FileSystemWatcher::handleTorrentParsed);
+    connect(m_parser, &Private::TorrentFileParser::torrentInvalid, this, &FileSystemWatcher::handleTorrentInvalid);
+    m_parserThread->start();
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFD >= 0) {
+        m_inotifyNotifier = new QSocketNotifier(m_inotifyFD, QSocketNotifier::Read, this);
+        connect(m_inotifyNotifier, &QSocketNotifier::activated, this, &FileSystemWatcher::readInotifyEvents);
+    }
+    else {
+        LogMsg(tr("Couldn't initialize inotify, local folders will be rescanned on every change"), Log::WARNING);
+    }
+#endif
+}
+
+FileSystemWatcher::~FileSystemWatcher()
+{
+    m_parserThread->quit();
+    m_parserThread->wait();
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFD >= 0) {
+        delete m_inotifyNotifier;
+        ::close(m_inotifyFD);
+    }
+#endif
 }
 
 QStringList FileSystemWatcher::directories() const
 {
     QStringList dirs = QFileSystemWatcher::directories();
+#ifdef Q_OS_LINUX
+    dirs << m_inotifyWatches.values();
+#endif
     for (const QDir &dir : asConst(m_watchedFolders))
         dirs << dir.canonicalPath();
     return dirs;
@@ -86,6 +145,19 @@ void FileSystemWatcher::addPath(const QString &path)
     }
 #endif
 
+#ifdef Q_OS_LINUX
+    // Only the files which were written or moved in are reported
+    if (m_inotifyFD >= 0) {
+        const int wd = inotify_add_watch(m_inotifyFD, QFile::encodeName(path).constData(), (IN_CLOSE_WRITE | IN_MOVED_TO));
+        if (wd >= 0) {
+            LogMsg(tr("Watching local folder: \"%1\"").arg(Utils::Fs::toNativePath(path)));
+            m_inotifyWatches[wd] = path;
+            scanLocalFolder(path);
+            return;
+        }
+    }
+#endif
+
     // Normal mode
     LogMsg(tr("Watching local folder: \"%1\"").arg(Utils::Fs::toNativePath(path)));
     QFileSystemWatcher::addPath(path);
@@ -94,12 +166,23 @@ void FileSystemWatcher::addPath(const QString &path)
 
 void FileSystemWatcher::removePath(const QString &path)
 {
+    m_folderFileStamps.remove(QDir(path).absolutePath());
+
     if (m_watchedFolders.removeOne(path)) {
         if (m_watchedFolders.isEmpty())
             m_watchTimer.stop();
         return;
     }
 
+#ifdef Q_OS_LINUX
+    const int wd = m_inotifyWatches.key(path, -1);
+    if (wd >= 0) {
+        inotify_rm_watch(m_inotifyFD, wd);
+        m_inotifyWatches.remove(wd);
+        return;
+    }
+#endif
+
     // Normal mode
     QFileSystemWatcher::removePath(path);
 }
@@ -117,25 +200,19 @@ void FileSystemWatcher::scanNetworkFolders()
 
 void FileSystemWatcher::processPartialTorrents()
 {
-    QStringList noLongerPartial;
-
     // Check which torrents are still partial
-    Algorithm::removeIf(m_partialTorrents, [&noLongerPartial](const QString &torrentPath, int &value)
+    Algorithm::removeIf(m_partialTorrents, [this](const QString &torrentPath, int &value)
     {
         if (!QFile::exists(torrentPath))
             return true;
 
-        if (BitTorrent::TorrentInfo::loadFromFile(torrentPath).isValid()) {
-            noLongerPartial << torrentPath;
-            return true;
-        }
-
         if (value >= MAX_PARTIAL_RETRIES) {
             QFile::rename(torrentPath, torrentPath + ".qbt_rejected");
             return true;
         }
 
         ++value;
+        parseTorrentFile(torrentPath);
         return false;
     });
 
@@ -148,29 +225,122 @@ void FileSystemWatcher::processPartialTorrents()
         qDebug("Still %d partial torrents after delayed processing.", m_partialTorrents.count());
         m_partialTorrentTimer.start(WATCH_INTERVAL);
     }
+}
+
+void FileSystemWatcher::handleTorrentParsed(const QString &path, const BitTorrent::TorrentInfo &info)
+{
+    m_parsingTorrents.remove(path);
+    m_partialTorrents.remove(path);
+
+    emit torrentAdded(path, info);
+}
+
+void FileSystemWatcher::handleTorrentInvalid(const QString &path)
+{
+    m_parsingTorrents.remove(path);
+
+    if (!m_partialTorrents.contains(path))
+        m_partialTorrents[path] = 0;
+
+    if (!m_partialTorrentTimer.isActive())
+        m_partialTorrentTimer.start(WATCH_INTERVAL);
+}
+
+#ifdef Q_OS_LINUX
+void FileSystemWatcher::readInotifyEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+    QStringList paths;
+    bool overflowed = false;
+
+    while (true) {
+        const ssize_t length = ::read(m_inotifyFD, buffer, sizeof(buffer));
+        if (length <= 0)
+            break; // no more pending events
+
+        const char *ptr = buffer;
+        while (ptr < (buffer + length)) {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += (sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+
+            // The watched folder was removed or unmounted
+            if (event->mask & IN_IGNORED) {
+                m_inotifyWatches.remove(event->wd);
+                continue;
+            }
+
+            if ((event->len == 0) || (event->mask & IN_ISDIR))
+                continue;
+
+            const QString folder = m_inotifyWatches.value(event->wd);
+            const QString fileName = QFile::decodeName(event->name);
+            if (!folder.isEmpty() && isWatchedFile(fileName))
+                paths << QDir(folder).absoluteFilePath(fileName);
+        }
+    }
+
+    // Some events were lost, fall back to comparing the folder contents
+    if (overflowed) {
+        for (const QString &folder : asConst(m_inotifyWatches))
+            processTorrentsInDir(folder);
+    }
 
-    // Notify of new torrents
-    if (!noLongerPartial.isEmpty())
-        emit torrentsAdded(noLongerPartial);
+    paths.removeDuplicates();
+    processFiles(paths);
 }
+#endif
 
 void FileSystemWatcher::processTorrentsInDir(const QDir &dir)
 {
-    QStringList torrents;
-    const QStringList files = dir.entryList({"*.torrent", "*.magnet"}, QDir::Files);
-    for (const QString &file : files) {
-        const QString fileAbsPath = dir.absoluteFilePath(file);
-        if (file.endsWith(".magnet"))
-            torrents << fileAbsPath;
-        else if (BitTorrent::TorrentInfo::loadFromFile(fileAbsPath).isValid())
-            torrents << fileAbsPath;
-        else if (!m_partialTorrents.contains(fileAbsPath))
-            m_partialTorrents[fileAbsPath] = 0;
+    QHash<QString, FileStamp> &fileStamps = m_folderFileStamps[dir.absolutePath()];
+    QHash<QString, FileStamp> currentFileStamps;
+
+    QStringList changedFiles;
+    const QFileInfoList files = dir.entryInfoList({"*.torrent", "*.magnet"}, QDir::Files);
+    for (const QFileInfo &fileInfo : files) {
+        const QString fileAbsPath = fileInfo.absoluteFilePath();
+        const FileStamp stamp {fileInfo.size(), fileInfo.lastModified()};
+
+        const auto iter = fileStamps.constFind(fileAbsPath);
+        if ((iter == fileStamps.cend()) || (iter->size != stamp.size) || (iter->lastModified != stamp.lastModified))
+            changedFiles << fileAbsPath;
+
+        currentFileStamps.insert(fileAbsPath, stamp);
     }
+    fileStamps.swap(currentFileStamps);
 
-    if (!torrents.empty())
-        emit torrentsAdded(torrents);
+    processFiles(changedFiles);
+}
 
-    if (!m_partialTorrents.empty() && !m_partialTorrentTimer.isActive())
-        m_partialTorrentTimer.start(WATCH_INTERVAL);
+void FileSystemWatcher::processFiles(const QStringList &paths)
+{
+    QStringList magnetFiles;
+    for (const QString &path : paths) {
+        if (isMagnetFile(path))
+            magnetFiles << path;
+        else
+            parseTorrentFile(path);
+    }
+
+    if (!magnetFiles.isEmpty())
+        emit magnetFilesAdded(magnetFiles);
+}
+
+void FileSystemWatcher::parseTorrentFile(const QString &path)
+{
+    // Wait for the result if the file is being parsed already
+    if (m_parsingTorrents.contains(path))
+        return;
+
+    m_parsingTorrents.insert(path);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, path]() { parser->parse(path); });
+#else
+    QMetaObject::invokeMethod(m_parser, "parse", Q_ARG(QString, path));
+#endif
 }
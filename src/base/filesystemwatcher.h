@@ -29,17 +29,33 @@
 #ifndef FILESYSTEMWATCHER_H
 #define FILESYSTEMWATCHER_H
 
+#include <QDateTime>
 #include <QDir>
 #include <QFileSystemWatcher>
 #include <QHash>
+#include <QSet>
 #include <QTimer>
 #include <QVector>
 
+class QSocketNotifier;
 class QStringList;
+class QThread;
+
+namespace BitTorrent
+{
+    class TorrentInfo;
+}
+
+namespace Private
+{
+    class TorrentFileParser;
+}
 
 /*
  * Subclassing QFileSystemWatcher in order to support Network File
  * System watching (NFS, CIFS) on Linux and Mac OS.
+ * On Linux, local folders are watched with inotify so that only the
+ * written or moved in files are processed instead of the whole folder.
  */
 class FileSystemWatcher : public QFileSystemWatcher
 {
@@ -47,21 +63,38 @@ class FileSystemWatcher : public QFileSystemWatcher
 
 public:
     explicit FileSystemWatcher(QObject *parent = nullptr);
+    ~FileSystemWatcher() override;
 
     QStringList directories() const;
     void addPath(const QString &path);
     void removePath(const QString &path);
 
 signals:
-    void torrentsAdded(const QStringList &pathList);
+    void magnetFilesAdded(const QStringList &pathList);
+    void torrentAdded(const QString &path, const BitTorrent::TorrentInfo &info);
 
 protected slots:
     void scanLocalFolder(const QString &path);
     void processPartialTorrents();
     void scanNetworkFolders();
 
+private slots:
+    void handleTorrentParsed(const QString &path, const BitTorrent::TorrentInfo &info);
+    void handleTorrentInvalid(const QString &path);
+#ifdef Q_OS_LINUX
+    void readInotifyEvents();
+#endif
+
 private:
+    struct FileStamp
+    {
+        qint64 size;
+        QDateTime lastModified;
+    };
+
     void processTorrentsInDir(const QDir &dir);
+    void processFiles(const QStringList &paths);
+    void parseTorrentFile(const QString &path);
 
     // Partial torrents
     QHash<QString, int> m_partialTorrents;
@@ -69,6 +102,18 @@ private:
 
     QVector<QDir> m_watchedFolders;
     QTimer m_watchTimer;
+    // files seen by the previous scan of each folder, unchanged ones aren't processed again
+    QHash<QString, QHash<QString, FileStamp>> m_folderFileStamps;
+
+    QThread *m_parserThread;
+    Private::TorrentFileParser *m_parser;
+    QSet<QString> m_parsingTorrents;
+
+#ifdef Q_OS_LINUX
+    int m_inotifyFD;
+    QSocketNotifier *m_inotifyNotifier;
+    QHash<int, QString> m_inotifyWatches;  // watch descriptor -> folder path
+#endif
 };
 
 #endif // FILESYSTEMWATCHER_H
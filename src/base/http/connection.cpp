@@ -30,23 +30,35 @@
 
 #include "connection.h"
 
+#include <QSslSocket>
 #include <QTcpSocket>
+#include <QTimer>
 
 #include "base/logger.h"
+#include "deferredresponse.h"
 #include "irequesthandler.h"
 #include "requestparser.h"
 #include "responsegenerator.h"
 
 using namespace Http;
 
+namespace
+{
+    const long BUFFER_LIMIT = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
+}
+
 Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
     : QObject(parent)
     , m_socket(socket)
     , m_requestHandler(requestHandler)
+    , m_deferredResponseTimer(new QTimer(this))
 {
     m_socket->setParent(this);
     m_idleTimer.start();
     connect(m_socket, &QTcpSocket::readyRead, this, &Connection::read);
+
+    m_deferredResponseTimer->setSingleShot(true);
+    connect(m_deferredResponseTimer, &QTimer::timeout, this, &Connection::handleDeferredResponseTimeout);
 }
 
 Connection::~Connection()
@@ -59,15 +71,22 @@ void Connection::read()
     m_idleTimer.restart();
     m_receivedData.append(m_socket->readAll());
 
-    while (!m_receivedData.isEmpty()) {
+    if (m_deferredResponse && (m_receivedData.size() > BUFFER_LIMIT)) {
+        Logger::instance()->addMessage(tr("Too much pipelined Http request data, closing socket. Limit: %1, IP: %2")
+            .arg(BUFFER_LIMIT).arg(m_socket->peerAddress().toString()), Log::WARNING);
+        m_socket->close();
+        return;
+    }
+
+    // pipelined requests wait until the pending response has been sent
+    while (!m_deferredResponse && !m_receivedData.isEmpty()) {
         const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
 
         switch (result.status) {
         case RequestParser::ParseStatus::Incomplete: {
-                const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
-                if (m_receivedData.size() > bufferLimit) {
+                if (m_receivedData.size() > BUFFER_LIMIT) {
                     Logger::instance()->addMessage(tr("Http request size exceeds limiation, closing socket. Limit: %1, IP: %2")
-                        .arg(bufferLimit).arg(m_socket->peerAddress().toString()), Log::WARNING);
+                        .arg(BUFFER_LIMIT).arg(m_socket->peerAddress().toString()), Log::WARNING);
 
                     Response resp(413, "Payload Too Large");
                     resp.headers[HEADER_CONNECTION] = "close";
@@ -93,15 +112,34 @@ void Connection::read()
         case RequestParser::ParseStatus::OK: {
                 const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
-                Response resp = m_requestHandler->processRequest(result.request, env);
+                const bool acceptsGzip = acceptsGzipEncoding(result.request.headers["accept-encoding"]);
 
-                if (acceptsGzipEncoding(result.request.headers["accept-encoding"]))
-                    resp.headers[HEADER_CONTENT_ENCODING] = "gzip";
+                if (!m_requestHandler) {
+                    // the request handler lives on another thread, wait for the response like for a deferred one
+                    m_receivedData = m_receivedData.mid(result.frameSize);
 
-                resp.headers[HEADER_CONNECTION] = "keep-alive";
+                    m_deferredResponse = new DeferredResponse(this);
+                    m_deferredAcceptsGzip = acceptsGzip;
+                    connect(m_deferredResponse, &DeferredResponse::finished, this, &Connection::handleDeferredResponse);
+                    m_deferredResponseTimer->start(m_deferredResponse->timeout());
 
-                sendResponse(resp);
+                    emit requestReceived(++m_lastRequestId, result.request, env);
+                    return;
+                }
+
+                const Response resp = m_requestHandler->processRequest(result.request, env);
                 m_receivedData = m_receivedData.mid(result.frameSize);
+
+                if (resp.deferred) {
+                    m_deferredResponse = resp.deferred;
+                    m_deferredResponse->setParent(this);
+                    m_deferredAcceptsGzip = acceptsGzip;
+                    connect(m_deferredResponse, &DeferredResponse::finished, this, &Connection::handleDeferredResponse);
+                    m_deferredResponseTimer->start(m_deferredResponse->timeout());
+                    return;
+                }
+
+                sendKeepAliveResponse(resp, acceptsGzip);
             }
             break;
 
@@ -112,13 +150,93 @@ void Connection::read()
     }
 }
 
+void Connection::start(const qlonglong socketDescriptor, const int idleTimeout)
+{
+    connect(m_socket, &QAbstractSocket::disconnected, this, &QObject::deleteLater);
+
+    if (!m_socket->setSocketDescriptor(socketDescriptor)) {
+        deleteLater();
+        return;
+    }
+
+    auto *sslSocket = qobject_cast<QSslSocket *>(m_socket);
+    if (sslSocket)
+        sslSocket->startServerEncryption();
+
+    auto *idleCheckTimer = new QTimer(this);
+    connect(idleCheckTimer, &QTimer::timeout, this, [this, idleTimeout]()
+    {
+        if (hasExpired(idleTimeout))
+            m_socket->close();
+    });
+    idleCheckTimer->start(idleTimeout);
+}
+
+void Connection::handleDispatchedResponse(const quint64 id, const Response &response)
+{
+    // ignore responses to requests that have timed out already
+    if (!m_deferredResponse || (id != m_lastRequestId))
+        return;
+
+    m_deferredResponse->finish(response);
+}
+
+void Connection::handleDeferredResponse(const Response &response)
+{
+    Q_ASSERT(sender() == m_deferredResponse);
+
+    releaseDeferredResponse();
+    sendKeepAliveResponse(response, m_deferredAcceptsGzip);
+
+    // continue with the requests received in the meantime
+    read();
+}
+
+void Connection::handleDeferredResponseTimeout()
+{
+    if (!m_deferredResponse)
+        return;
+
+    Logger::instance()->addMessage(tr("Http request timed out. IP: %1")
+        .arg(m_socket->peerAddress().toString()), Log::WARNING);
+
+    releaseDeferredResponse();
+    sendKeepAliveResponse(Response(503, "Service Unavailable"), false);
+
+    read();
+}
+
+void Connection::releaseDeferredResponse()
+{
+    m_deferredResponseTimer->stop();
+
+    // a late finish() goes nowhere
+    m_deferredResponse->disconnect(this);
+    m_deferredResponse->deleteLater();
+    m_deferredResponse = nullptr;
+}
+
 void Connection::sendResponse(const Response &response) const
 {
     m_socket->write(toByteArray(response));
 }
 
+void Connection::sendKeepAliveResponse(Response response, const bool acceptsGzip) const
+{
+    if (acceptsGzip)
+        response.headers[HEADER_CONTENT_ENCODING] = "gzip";
+
+    response.headers[HEADER_CONNECTION] = "keep-alive";
+
+    sendResponse(response);
+}
+
 bool Connection::hasExpired(const qint64 timeout) const
 {
+    // don't drop a connection that is still waiting for its response
+    if (m_deferredResponse)
+        return false;
+
     return m_idleTimer.hasExpired(timeout);
 }
 
@@ -33,14 +33,22 @@
 
 #include <QElapsedTimer>
 #include <QObject>
+#include <QPointer>
 
 class QTcpSocket;
+class QTimer;
 
 namespace Http
 {
+    class DeferredResponse;
     class IRequestHandler;
+    struct Environment;
+    struct Request;
     struct Response;
 
+    // If `requestHandler` is null, the connection is meant to run on an I/O thread:
+    // requests are emitted through requestReceived() and their responses are
+    // expected back in handleDispatchedResponse(), see RequestDispatcher.
     class Connection : public QObject
     {
         Q_OBJECT
@@ -53,17 +61,36 @@ namespace Http
         bool hasExpired(qint64 timeout) const;
         bool isClosed() const;
 
+    public slots:
+        // Sets up the socket on the thread the connection lives in. The connection
+        // then deletes itself once it's closed or idle for `idleTimeout` msecs.
+        void start(qlonglong socketDescriptor, int idleTimeout);
+        void handleDispatchedResponse(quint64 id, const Http::Response &response);
+
+    signals:
+        void requestReceived(quint64 id, const Http::Request &request, const Http::Environment &env);
+
     private slots:
         void read();
+        void handleDeferredResponse(const Http::Response &response);
+        void handleDeferredResponseTimeout();
 
     private:
         static bool acceptsGzipEncoding(QString codings);
         void sendResponse(const Response &response) const;
+        void sendKeepAliveResponse(Response response, bool acceptsGzip) const;
+        void releaseDeferredResponse();
 
         QTcpSocket *m_socket;
         IRequestHandler *m_requestHandler;
         QByteArray m_receivedData;
         QElapsedTimer m_idleTimer;
+
+        // response still being prepared by the request handler
+        QPointer<DeferredResponse> m_deferredResponse;
+        QTimer *m_deferredResponseTimer;
+        bool m_deferredAcceptsGzip = false;
+        quint64 m_lastRequestId = 0;
     };
 }
 
@@ -203,7 +203,8 @@ bool RequestParser::parseRequestLine(const QString &line)
             const QString paramName = QString::fromUtf8(QByteArray::fromPercentEncoding(nameComponent).replace('+', ' '));
             const QByteArray paramValue = QByteArray::fromPercentEncoding(valueComponent).replace('+', ' ');
 
-            m_request.query[paramName] = paramValue;
+            // a parameter may be repeated, e.g. `info_hash` in a multi-torrent scrape
+            m_request.query.insertMulti(paramName, paramValue);
         }
     }
 
@@ -37,11 +37,14 @@
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 
 #include "base/algorithm.h"
+#include "base/global.h"
 #include "base/utils/net.h"
 #include "connection.h"
+#include "requestdispatcher.h"
 
 namespace
 {
@@ -74,6 +77,10 @@ Server::Server(IRequestHandler *requestHandler, QObject *parent)
 {
     setProxy(QNetworkProxy::NoProxy);
 
+    qRegisterMetaType<Environment>();
+    qRegisterMetaType<Request>();
+    qRegisterMetaType<Response>();
+
     QSslConfiguration sslConf {QSslConfiguration::defaultConfiguration()};
     sslConf.setCiphers(safeCipherList());
     QSslConfiguration::setDefaultConfiguration(sslConf);
@@ -83,9 +90,16 @@ Server::Server(IRequestHandler *requestHandler, QObject *parent)
     dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL * 1000);
 }
 
+Server::~Server()
+{
+    // the connections left are deleted on their own threads as these finish
+    for (QThread *thread : asConst(m_ioThreads))
+        stopIOThread(thread);
+}
+
 void Server::incomingConnection(const qintptr socketDescriptor)
 {
-    if (m_connections.size() >= CONNECTIONS_LIMIT) return;
+    if ((m_connections.size() + m_ioConnectionsCount) >= CONNECTIONS_LIMIT) return;
 
     QTcpSocket *serverSocket;
     if (m_https)
@@ -93,24 +107,54 @@ void Server::incomingConnection(const qintptr socketDescriptor)
     else
         serverSocket = new QTcpSocket(this);
 
-    if (!serverSocket->setSocketDescriptor(socketDescriptor)) {
-        delete serverSocket;
-        return;
-    }
-
     if (m_https) {
         static_cast<QSslSocket *>(serverSocket)->setProtocol(QSsl::SecureProtocols);
         static_cast<QSslSocket *>(serverSocket)->setPrivateKey(m_key);
         static_cast<QSslSocket *>(serverSocket)->setLocalCertificateChain(m_certificates);
         static_cast<QSslSocket *>(serverSocket)->setPeerVerifyMode(QSslSocket::VerifyNone);
-        static_cast<QSslSocket *>(serverSocket)->startServerEncryption();
     }
 
+    if (!m_ioThreads.isEmpty()) {
+        startIOConnection(serverSocket, socketDescriptor);
+        return;
+    }
+
+    if (!serverSocket->setSocketDescriptor(socketDescriptor)) {
+        delete serverSocket;
+        return;
+    }
+
+    if (m_https)
+        static_cast<QSslSocket *>(serverSocket)->startServerEncryption();
+
     auto *c = new Connection(serverSocket, m_requestHandler, this);
     m_connections.insert(c);
     connect(serverSocket, &QAbstractSocket::disconnected, this, [c, this]() { removeConnection(c); });
 }
 
+void Server::startIOConnection(QTcpSocket *socket, const qintptr socketDescriptor)
+{
+    // The socket is set up on the I/O thread, requests come back here through the dispatcher
+    socket->setParent(nullptr);
+    auto *connection = new Connection(socket, nullptr);
+    auto *dispatcher = new RequestDispatcher(m_requestHandler, this);
+    connect(connection, &Connection::requestReceived, dispatcher, &RequestDispatcher::dispatch);
+    connect(dispatcher, &RequestDispatcher::responseReady, connection, &Connection::handleDispatchedResponse);
+    connect(connection, &QObject::destroyed, dispatcher, &QObject::deleteLater);
+
+    QThread *thread = m_ioThreads[m_nextIOThread];
+    m_nextIOThread = (m_nextIOThread + 1) % m_ioThreads.size();
+
+    connection->moveToThread(thread);
+    // the connection deletes itself once closed, or along with its thread's event loop
+    connect(thread, &QThread::finished, connection, &QObject::deleteLater);
+    ++m_ioConnectionsCount;
+    connect(connection, &QObject::destroyed, this, [this]() { --m_ioConnectionsCount; }, Qt::QueuedConnection);
+
+    QMetaObject::invokeMethod(connection, "start", Qt::QueuedConnection
+        , Q_ARG(qlonglong, socketDescriptor), Q_ARG(int, KEEP_ALIVE_DURATION));
+}
+
 void Server::removeConnection(Connection *connection)
 {
     m_connections.remove(connection);
@@ -145,6 +189,34 @@ bool Server::setupHttps(const QByteArray &certificates, const QByteArray &privat
     return true;
 }
 
+void Server::setIOThreadCount(int count)
+{
+    count = qMax(0, count);
+
+    while (m_ioThreads.size() < count) {
+        auto *thread = new QThread(this);
+        thread->setObjectName(QLatin1String("HTTP I/O"));
+        thread->start();
+        m_ioThreads.append(thread);
+    }
+
+    // the connections running on the threads dropped are closed
+    while (m_ioThreads.size() > count) {
+        QThread *thread = m_ioThreads.takeLast();
+        stopIOThread(thread);
+        delete thread;
+    }
+
+    if (m_nextIOThread >= m_ioThreads.size())
+        m_nextIOThread = 0;
+}
+
+void Server::stopIOThread(QThread *thread)
+{
+    thread->quit();
+    thread->wait();
+}
+
 void Server::disableHttps()
 {
     m_https = false;
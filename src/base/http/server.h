@@ -35,6 +35,9 @@
 #include <QSslCertificate>
 #include <QSslKey>
 #include <QTcpServer>
+#include <QVector>
+
+class QThread;
 
 namespace Http
 {
@@ -48,20 +51,35 @@ namespace Http
 
     public:
         explicit Server(IRequestHandler *requestHandler, QObject *parent = nullptr);
+        ~Server() override;
 
         bool setupHttps(const QByteArray &certificates, const QByteArray &privateKey);
         void disableHttps();
 
+        // Run connections (TLS, request parsing, response encoding) on `count` I/O threads,
+        // only request handling stays on the server's thread. 0 disables it.
+        // Added threads are used by new connections only, the connections
+        // running on removed threads are closed.
+        void setIOThreadCount(int count);
+
     private slots:
         void dropTimedOutConnection();
 
     private:
         void incomingConnection(qintptr socketDescriptor) override;
         void removeConnection(Connection *connection);
+        void startIOConnection(QTcpSocket *socket, qintptr socketDescriptor);
+        void stopIOThread(QThread *thread);
 
         IRequestHandler *m_requestHandler;
         QSet<Connection *> m_connections;  // for tracking persistent connections
 
+        // connections running on I/O threads are owned by these threads,
+        // they delete themselves when closed
+        QVector<QThread *> m_ioThreads;
+        int m_ioConnectionsCount = 0;
+        int m_nextIOThread = 0;
+
         bool m_https;
         QList<QSslCertificate> m_certificates;
         QSslKey m_key;
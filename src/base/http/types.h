@@ -31,6 +31,8 @@
 #define HTTP_TYPES_H
 
 #include <QHostAddress>
+#include <QMetaType>
+#include <QPointer>
 #include <QString>
 #include <QVector>
 
@@ -38,9 +40,12 @@
 
 namespace Http
 {
+    class DeferredResponse;
+
     const char METHOD_GET[] = "GET";
     const char METHOD_POST[] = "POST";
 
+    const char HEADER_AUTHORIZATION[] = "authorization";
     const char HEADER_CACHE_CONTROL[] = "cache-control";
     const char HEADER_CONNECTION[] = "connection";
     const char HEADER_CONTENT_DISPOSITION[] = "content-disposition";
@@ -98,7 +103,7 @@ namespace Http
         QString method;
         QString path;
         QStringMap headers;
-        QHash<QString, QByteArray> query;
+        QHash<QString, QByteArray> query;  // may hold several values per key
         QHash<QString, QString> posts;
         QVector<UploadedFile> files;
     };
@@ -115,6 +120,9 @@ namespace Http
         QStringMap headers;
         QByteArray content;
 
+        // set when the actual response will be delivered later, see DeferredResponse
+        QPointer<DeferredResponse> deferred;
+
         Response(uint code = 200, const QString &text = "OK")
             : status {code, text}
         {
@@ -122,4 +130,9 @@ namespace Http
     };
 }
 
+// passed between the I/O threads and the main thread
+Q_DECLARE_METATYPE(Http::Environment)
+Q_DECLARE_METATYPE(Http::Request)
+Q_DECLARE_METATYPE(Http::Response)
+
 #endif // HTTP_TYPES_H
@@ -97,6 +97,8 @@ Smtp::Smtp(QObject *parent)
     , m_state(Init)
     , m_useSsl(false)
     , m_authType(AuthPlain)
+    , m_sent(false)
+    , m_finished(false)
 {
     static bool needToRegisterMetaType = true;
 
@@ -112,7 +114,7 @@ Smtp::Smtp(QObject *parent)
 #endif
 
     connect(m_socket, &QIODevice::readyRead, this, &Smtp::readyRead);
-    connect(m_socket, &QAbstractSocket::disconnected, this, &QObject::deleteLater);
+    connect(m_socket, &QAbstractSocket::disconnected, this, &Smtp::finish);
     connect(m_socket, qOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error)
             , this, &Smtp::error);
 
@@ -273,6 +275,7 @@ void Smtp::readyRead()
                 m_socket->flush();
                 // here, we just close.
                 m_state = Close;
+                m_sent = true;
             }
             else {
                 logError(QLatin1String("Message was rejected by the server, error: ") + line);
@@ -542,4 +545,17 @@ void Smtp::error(QAbstractSocket::SocketError socketError)
     // an email
     if (socketError != QAbstractSocket::RemoteHostClosedError)
         logError(m_socket->errorString());
+
+    // no disconnected() signal follows if the connection couldn't be established
+    if (m_socket->state() == QAbstractSocket::UnconnectedState)
+        finish();
+}
+
+void Smtp::finish()
+{
+    if (m_finished) return;
+
+    m_finished = true;
+    emit finished(m_sent);
+    deleteLater();
 }
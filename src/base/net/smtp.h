@@ -58,6 +58,10 @@ namespace Net
 
         void sendMail(const QString &from, const QString &to, const QString &subject, const QString &body);
 
+    signals:
+        // emitted once, right before the object deletes itself
+        void finished(bool success);
+
     private slots:
         void readyRead();
         void error(QAbstractSocket::SocketError socketError);
@@ -99,6 +103,7 @@ namespace Net
         void authPlain();
         void authLogin();
         void logError(const QString &msg);
+        void finish();
         QString getCurrentDateTime() const;
 
         QByteArray m_message;
@@ -117,6 +122,8 @@ namespace Net
         AuthType m_authType;
         QString m_username;
         QString m_password;
+        bool m_sent;
+        bool m_finished;
     };
 }
 
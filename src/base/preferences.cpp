@@ -633,6 +633,27 @@ void Preferences::setWebUISessionTimeout(const int timeout)
     setValue("Preferences/WebUI/SessionTimeout", timeout);
 }
 
+QByteArray Preferences::getWebUIAPITokenHash() const
+{
+    return value("Preferences/WebUI/APITokenHash").toByteArray();
+}
+
+void Preferences::setWebUIAPITokenHash(const QByteArray &hash)
+{
+    setValue("Preferences/WebUI/APITokenHash", hash);
+}
+
+int Preferences::getWebUIIOThreadCount() const
+{
+    // 0 means that the connections are served on the main thread
+    return qBound(0, value("Preferences/WebUI/IOThreads", 0).toInt(), 16);
+}
+
+void Preferences::setWebUIIOThreadCount(const int count)
+{
+    setValue("Preferences/WebUI/IOThreads", qBound(0, count, 16));
+}
+
 bool Preferences::isWebUiClickjackingProtectionEnabled() const
 {
     return value("Preferences/WebUI/ClickjackingProtection", true).toBool();
@@ -804,6 +825,46 @@ void Preferences::setAutoRunProgram(const QString &program)
     setValue("AutoRun/program", program);
 }
 
+int Preferences::getCompletionHookMaxJobs() const
+{
+    return qBound(1, value("AutoRun/MaxConcurrentJobs", 4).toInt(), 64);
+}
+
+void Preferences::setCompletionHookMaxJobs(const int count)
+{
+    setValue("AutoRun/MaxConcurrentJobs", qBound(1, count, 64));
+}
+
+int Preferences::getCompletionHookMaxRetries() const
+{
+    return qBound(0, value("AutoRun/MaxRetries", 3).toInt(), 10);
+}
+
+void Preferences::setCompletionHookMaxRetries(const int count)
+{
+    setValue("AutoRun/MaxRetries", qBound(0, count, 10));
+}
+
+int Preferences::getCompletionHookTimeout() const
+{
+    return qBound(0, value("AutoRun/JobTimeout", 0).toInt(), 86400);
+}
+
+void Preferences::setCompletionHookTimeout(const int seconds)
+{
+    setValue("AutoRun/JobTimeout", qBound(0, seconds, 86400));
+}
+
+QString Preferences::getCompletionWebhookURL() const
+{
+    return value("AutoRun/WebhookURL").toString();
+}
+
+void Preferences::setCompletionWebhookURL(const QString &url)
+{
+    setValue("AutoRun/WebhookURL", url.trimmed());
+}
+
 bool Preferences::shutdownWhenDownloadsComplete() const
 {
     return value("Preferences/Downloads/AutoShutDownOnCompletion", false).toBool();
@@ -1054,6 +1115,26 @@ void Preferences::setTrackerPort(const int port)
     setValue("Preferences/Advanced/trackerPort", port);
 }
 
+int Preferences::getTrackerMaxTorrents() const
+{
+    return qMax(1, value("Preferences/Advanced/trackerMaxTorrents", 10000).toInt());
+}
+
+void Preferences::setTrackerMaxTorrents(const int num)
+{
+    setValue("Preferences/Advanced/trackerMaxTorrents", qMax(1, num));
+}
+
+int Preferences::getTrackerMaxPeersPerTorrent() const
+{
+    return qMax(1, value("Preferences/Advanced/trackerMaxPeersPerTorrent", 200).toInt());
+}
+
+void Preferences::setTrackerMaxPeersPerTorrent(const int num)
+{
+    setValue("Preferences/Advanced/trackerMaxPeersPerTorrent", qMax(1, num));
+}
+
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
 bool Preferences::isUpdateCheckEnabled() const
 {
@@ -196,6 +196,10 @@ public:
     void setWebUIPassword(const QByteArray &password);
     int getWebUISessionTimeout() const;
     void setWebUISessionTimeout(int timeout);
+    QByteArray getWebUIAPITokenHash() const;
+    void setWebUIAPITokenHash(const QByteArray &hash);
+    int getWebUIIOThreadCount() const;
+    void setWebUIIOThreadCount(int count);
 
     // WebUI security
     bool isWebUiClickjackingProtectionEnabled() const;
@@ -238,6 +242,14 @@ public:
     void setAutoRunEnabled(bool enabled);
     QString getAutoRunProgram() const;
     void setAutoRunProgram(const QString &program);
+    int getCompletionHookMaxJobs() const;
+    void setCompletionHookMaxJobs(int count);
+    int getCompletionHookMaxRetries() const;
+    void setCompletionHookMaxRetries(int count);
+    int getCompletionHookTimeout() const;
+    void setCompletionHookTimeout(int seconds);
+    QString getCompletionWebhookURL() const;
+    void setCompletionWebhookURL(const QString &url);
     bool shutdownWhenDownloadsComplete() const;
     void setShutdownWhenDownloadsComplete(bool shutdown);
     bool suspendWhenDownloadsComplete() const;
@@ -276,6 +288,10 @@ public:
 #endif
     int getTrackerPort() const;
     void setTrackerPort(int port);
+    int getTrackerMaxTorrents() const;
+    void setTrackerMaxTorrents(int num);
+    int getTrackerMaxPeersPerTorrent() const;
+    void setTrackerMaxPeersPerTorrent(int num);
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
     bool isUpdateCheckEnabled() const;
     void setUpdateCheckEnabled(bool enabled);
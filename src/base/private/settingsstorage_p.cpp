@@ -0,0 +1,138 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2016  Vladimir Golovnev <glassez@yandex.ru>
+ * Copyright (C) 2014  sledgehammer999 <hammered999@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "settingsstorage_p.h"
+
+#include <QFile>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+
+using namespace Private;
+
+SettingsWriter::SettingsWriter(const QString &name)
+    : m_name(name)
+{
+}
+
+void SettingsWriter::write(const QVariantHash &data)
+{
+    emit finished(TransactionalSettings(m_name).write(data));
+}
+
+QVariantHash TransactionalSettings::read()
+{
+    QVariantHash res;
+
+    const QString newPath = deserialize(m_name + QLatin1String("_new"), res);
+    if (!newPath.isEmpty()) { // "_new" file is NOT empty
+        // This means that the PC closed either due to power outage
+        // or because the disk was full. In any case the settings weren't transferred
+        // in their final position. So assume that qbittorrent_new.ini/qbittorrent_new.conf
+        // contains the most recent settings.
+        Logger::instance()->addMessage(QObject::tr("Detected unclean program exit. Using fallback file to restore settings: %1")
+                .arg(Utils::Fs::toNativePath(newPath))
+            , Log::WARNING);
+
+        QString finalPath = newPath;
+        int index = finalPath.lastIndexOf("_new", -1, Qt::CaseInsensitive);
+        finalPath.remove(index, 4);
+
+        Utils::Fs::forceRemove(finalPath);
+        QFile::rename(newPath, finalPath);
+    }
+    else {
+        deserialize(m_name, res);
+    }
+
+    return res;
+}
+
+bool TransactionalSettings::write(const QVariantHash &data)
+{
+    // QSettings deletes the file before writing it out. This can result in problems
+    // if the disk is full or a power outage occurs. Those events might occur
+    // between deleting the file and recreating it. This is a safety measure.
+    // Write everything to qBittorrent_new.ini/qBittorrent_new.conf and if it succeeds
+    // replace qBittorrent.ini/qBittorrent.conf with it.
+    const QString newPath = serialize(m_name + QLatin1String("_new"), data);
+    if (newPath.isEmpty()) {
+        Utils::Fs::forceRemove(newPath);
+        return false;
+    }
+
+    QString finalPath = newPath;
+    int index = finalPath.lastIndexOf("_new", -1, Qt::CaseInsensitive);
+    finalPath.remove(index, 4);
+
+    Utils::Fs::forceRemove(finalPath);
+    return QFile::rename(newPath, finalPath);
+}
+
+QString TransactionalSettings::deserialize(const QString &name, QVariantHash &data)
+{
+    SettingsPtr settings = Profile::instance().applicationSettings(name);
+
+    if (settings->allKeys().isEmpty())
+        return {};
+
+    // Copy everything into memory. This means even keys inserted in the file manually
+    // or that we don't touch directly in this code (eg disabled by ifdef). This ensures
+    // that they will be copied over when save our settings to disk.
+    for (const QString &key : asConst(settings->allKeys()))
+        data.insert(key, settings->value(key));
+
+    return settings->fileName();
+}
+
+QString TransactionalSettings::serialize(const QString &name, const QVariantHash &data)
+{
+    SettingsPtr settings = Profile::instance().applicationSettings(name);
+    for (auto i = data.begin(); i != data.end(); ++i)
+        settings->setValue(i.key(), i.value());
+
+    settings->sync(); // Important to get error status
+
+    switch (settings->status()) {
+    case QSettings::NoError:
+        return settings->fileName();
+    case QSettings::AccessError:
+        Logger::instance()->addMessage(QObject::tr("An access error occurred while trying to write the configuration file."), Log::CRITICAL);
+        break;
+    case QSettings::FormatError:
+        Logger::instance()->addMessage(QObject::tr("A format error occurred while trying to write the configuration file."), Log::CRITICAL);
+        break;
+    default:
+        Logger::instance()->addMessage(QObject::tr("An unknown error occurred while trying to write the configuration file."), Log::CRITICAL);
+        break;
+    }
+    return {};
+}
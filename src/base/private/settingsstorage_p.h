@@ -0,0 +1,80 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2016  Vladimir Golovnev <glassez@yandex.ru>
+ * Copyright (C) 2014  sledgehammer999 <hammered999@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QVariantHash>
+
+namespace Private
+{
+    // Encapsulates serialization of settings in "atomic" way.
+    // write() does not leave half-written files,
+    // read() has a workaround for a case of power loss during a previous serialization
+    class TransactionalSettings
+    {
+    public:
+        explicit TransactionalSettings(const QString &name)
+            : m_name(name)
+        {
+        }
+
+        QVariantHash read();
+        bool write(const QVariantHash &data);
+
+    private:
+        // we return actual file names used by QSettings because
+        // there is no other way to get that name except
+        // actually create a QSettings object.
+        // if serialization operation was not successful we return empty string
+        QString deserialize(const QString &name, QVariantHash &data);
+        QString serialize(const QString &name, const QVariantHash &data);
+
+        const QString m_name;
+    };
+
+    // Writes the settings snapshots in the SettingsStorage I/O thread
+    class SettingsWriter : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SettingsWriter)
+
+    public:
+        explicit SettingsWriter(const QString &name);
+
+    public slots:
+        void write(const QVariantHash &data);
+
+    signals:
+        void finished(bool success);
+
+    private:
+        const QString m_name;
+    };
+}
@@ -357,6 +357,7 @@ namespace
     };
 
     // Ported to Qt from KDElibs4
+    // Returns an invalid QDateTime if the string can't be parsed
     QDateTime parseDate(const QString &string)
     {
         const char shortDay[][4] = {
@@ -377,7 +378,7 @@ namespace
 
         const QString str = string.trimmed();
         if (str.isEmpty())
-            return QDateTime::currentDateTime();
+            return {};
 
         int nyear  = 6;   // indexes within string to values
         int nmonth = 4;
@@ -395,13 +396,13 @@ namespace
             const bool h1 = (parts[3] == QLatin1String("-"));
             const bool h2 = (parts[5] == QLatin1String("-"));
             if (h1 != h2)
-                return QDateTime::currentDateTime();
+                return {};
         }
         else {
             // Check for the obsolete form "Wdy Mon DD HH:MM:SS YYYY"
             rx = QRegExp("^([A-Z][a-z]+)\\s+(\\S+)\\s+(\\d\\d)\\s+(\\d\\d):(\\d\\d):(\\d\\d)\\s+(\\d\\d\\d\\d)$");
             if (str.indexOf(rx))
-                return QDateTime::currentDateTime();
+                return {};
             nyear  = 7;
             nmonth = 2;
             nday   = 3;
@@ -418,13 +419,13 @@ namespace
         const int hour = parts[nhour].toInt(&ok[2]);
         const int minute = parts[nmin].toInt(&ok[3]);
         if (!ok[0] || !ok[1] || !ok[2] || !ok[3])
-            return QDateTime::currentDateTime();
+            return {};
 
         int second = 0;
         if (!parts[nsec].isEmpty()) {
             second = parts[nsec].toInt(&ok[0]);
             if (!ok[0])
-                return QDateTime::currentDateTime();
+                return {};
         }
 
         const bool leapSecond = (second == 60);
@@ -500,20 +501,20 @@ namespace
 
         const QDate qDate(year, month + 1, day);   // convert date, and check for out-of-range
         if (!qDate.isValid())
-            return QDateTime::currentDateTime();
+            return {};
 
         const QTime qTime(hour, minute, second);
         QDateTime result(qDate, qTime, Qt::UTC);
         if (offset)
             result = result.addSecs(-offset);
         if (!result.isValid())
-            return QDateTime::currentDateTime();    // invalid date/time
+            return {};    // invalid date/time
 
         if (leapSecond) {
             // Validate a leap second time. Leap seconds are inserted after 23:59:59 UTC.
             // Convert the time to UTC and check that it is 00:00:00.
             if ((hour*3600 + minute*60 + 60 - offset + 86400*5) % 86400)   // (max abs(offset) is 100 hours)
-                return QDateTime::currentDateTime();    // the time isn't the last second of the day
+                return {};    // the time isn't the last second of the day
         }
 
         return result;
@@ -522,6 +523,10 @@ namespace
 
 using namespace RSS::Private;
 
+// Feeds usually list their items newest first, in which case once this many
+// already known articles are met in a row the rest of the document has been seen before
+const int KNOWN_ARTICLES_IN_ROW_TO_STOP = 3;
+
 const int ParsingResultTypeId = qRegisterMetaType<ParsingResult>();
 
 Parser::Parser(const QString lastBuildDate)
@@ -529,20 +534,25 @@ Parser::Parser(const QString lastBuildDate)
     m_result.lastBuildDate = lastBuildDate;
 }
 
-void Parser::parse(const QByteArray &feedData)
+void Parser::parse(const QByteArray &feedData, const QStringList &knownArticleIDs)
 {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
-    QMetaObject::invokeMethod(this, [this, feedData]() { parse_impl(feedData); }
+    QMetaObject::invokeMethod(this, [this, feedData, knownArticleIDs]() { parse_impl(feedData, knownArticleIDs); }
                               , Qt::QueuedConnection);
 #else
     QMetaObject::invokeMethod(this, "parse_impl", Qt::QueuedConnection
-                              , Q_ARG(QByteArray, feedData));
+                              , Q_ARG(QByteArray, feedData), Q_ARG(QStringList, knownArticleIDs));
 #endif
 }
 
 // read and create items from a rss document
-void Parser::parse_impl(const QByteArray &feedData)
+void Parser::parse_impl(const QByteArray &feedData, const QStringList &knownArticleIDs)
 {
+    m_knownArticleIDs = knownArticleIDs.toSet();
+    m_knownArticlesInRow = 0;
+    m_isNewestFirst = true;
+    m_lastArticleDate = {};
+
     QXmlStreamReader xml(feedData);
     XmlStreamEntityResolver resolver;
     xml.setEntityResolver(&resolver);
@@ -585,11 +595,13 @@ void Parser::parse_impl(const QByteArray &feedData)
     emit finished(m_result);
     m_result.articles.clear(); // clear articles only
     m_articleIDs.clear();
+    m_knownArticleIDs.clear();
 }
 
 void Parser::parseRssArticle(QXmlStreamReader &xml)
 {
     QVariantHash article;
+    QDateTime articleDate;
     QString altTorrentUrl;
 
     while (!xml.atEnd()) {
@@ -620,7 +632,8 @@ void Parser::parseRssArticle(QXmlStreamReader &xml)
                 article[Article::KeyDescription] = xml.readElementText(QXmlStreamReader::IncludeChildElements);
             }
             else if (name == QLatin1String("pubDate")) {
-                article[Article::KeyDate] = parseDate(xml.readElementText().trimmed());
+                articleDate = parseDate(xml.readElementText().trimmed());
+                article[Article::KeyDate] = (articleDate.isValid() ? articleDate : QDateTime::currentDateTime());
             }
             else if (name == QLatin1String("author")) {
                 article[Article::KeyAuthor] = xml.readElementText().trimmed();
@@ -637,7 +650,7 @@ void Parser::parseRssArticle(QXmlStreamReader &xml)
     if (article[Article::KeyTorrentURL].toString().isEmpty())
         article[Article::KeyTorrentURL] = altTorrentUrl;
 
-    addArticle(article);
+    addArticle(article, articleDate);
 }
 
 void Parser::parseRSSChannel(QXmlStreamReader &xml)
@@ -661,6 +674,10 @@ void Parser::parseRSSChannel(QXmlStreamReader &xml)
             }
             else if (xml.name() == QLatin1String("item")) {
                 parseRssArticle(xml);
+                if (reachedKnownArticles()) {
+                    qDebug() << "The rest of the RSS feed is already known, aborting parsing.";
+                    return;
+                }
             }
         }
     }
@@ -669,6 +686,7 @@ void Parser::parseRSSChannel(QXmlStreamReader &xml)
 void Parser::parseAtomArticle(QXmlStreamReader &xml)
 {
     QVariantHash article;
+    QDateTime articleDate;
     bool doubleContent = false;
 
     while (!xml.atEnd()) {
@@ -712,7 +730,7 @@ void Parser::parseAtomArticle(QXmlStreamReader &xml)
             }
             else if (name == QLatin1String("updated")) {
                 // ATOM uses standard compliant date, don't do fancy stuff
-                const QDateTime articleDate = QDateTime::fromString(xml.readElementText().trimmed(), Qt::ISODate);
+                articleDate = QDateTime::fromString(xml.readElementText().trimmed(), Qt::ISODate);
                 article[Article::KeyDate] = (articleDate.isValid() ? articleDate : QDateTime::currentDateTime());
             }
             else if (name == QLatin1String("author")) {
@@ -732,7 +750,7 @@ void Parser::parseAtomArticle(QXmlStreamReader &xml)
         }
     }
 
-    addArticle(article);
+    addArticle(article, articleDate);
 }
 
 void Parser::parseAtomChannel(QXmlStreamReader &xml)
@@ -758,13 +776,23 @@ void Parser::parseAtomChannel(QXmlStreamReader &xml)
             }
             else if (xml.name() == QLatin1String("entry")) {
                 parseAtomArticle(xml);
+                if (reachedKnownArticles()) {
+                    qDebug() << "The rest of the RSS feed is already known, aborting parsing.";
+                    return;
+                }
             }
         }
     }
 }
 
-void Parser::addArticle(QVariantHash article)
+void Parser::addArticle(QVariantHash article, const QDateTime &date)
 {
+    // Stopping at known articles is only safe if the feed lists its newest
+    // articles first, which is trusted only as long as their dates confirm it
+    if (!date.isValid() || (m_lastArticleDate.isValid() && (date > m_lastArticleDate)))
+        m_isNewestFirst = false;
+    m_lastArticleDate = date;
+
     QVariant &torrentURL = article[Article::KeyTorrentURL];
     if (torrentURL.toString().isEmpty())
         torrentURL = article[Article::KeyLink];
@@ -791,5 +819,19 @@ void Parser::addArticle(QVariantHash article)
     }
 
     m_articleIDs.insert(localId.toString());
+
+    if (m_knownArticleIDs.contains(localId.toString())) {
+        // The feed only needs the ID of an already known article
+        ++m_knownArticlesInRow;
+        m_result.articles.prepend(QVariantHash {{Article::KeyId, localId}});
+        return;
+    }
+
+    m_knownArticlesInRow = 0;
     m_result.articles.prepend(article);
 }
+
+bool Parser::reachedKnownArticles() const
+{
+    return (m_isNewestFirst && (m_knownArticlesInRow >= KNOWN_ARTICLES_IN_ROW_TO_STOP));
+}
@@ -29,10 +29,12 @@
 
 #pragma once
 
+#include <QDateTime>
 #include <QList>
 #include <QObject>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVariantHash>
 
 class QXmlStreamReader;
@@ -55,22 +57,27 @@ namespace RSS
 
         public:
             explicit Parser(QString lastBuildDate);
-            void parse(const QByteArray &feedData);
+            void parse(const QByteArray &feedData, const QStringList &knownArticleIDs = {});
 
         signals:
             void finished(const RSS::Private::ParsingResult &result);
 
         private:
-            Q_INVOKABLE void parse_impl(const QByteArray &feedData);
+            Q_INVOKABLE void parse_impl(const QByteArray &feedData, const QStringList &knownArticleIDs);
             void parseRssArticle(QXmlStreamReader &xml);
             void parseRSSChannel(QXmlStreamReader &xml);
             void parseAtomArticle(QXmlStreamReader &xml);
             void parseAtomChannel(QXmlStreamReader &xml);
-            void addArticle(QVariantHash article);
+            void addArticle(QVariantHash article, const QDateTime &date);
+            bool reachedKnownArticles() const;
 
             QString m_baseUrl;
             ParsingResult m_result;
             QSet<QString> m_articleIDs;
+            QSet<QString> m_knownArticleIDs;
+            int m_knownArticlesInRow = 0;
+            bool m_isNewestFirst = true;
+            QDateTime m_lastArticleDate;
         };
     }
 }
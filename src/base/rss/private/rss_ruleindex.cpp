@@ -0,0 +1,206 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "rss_ruleindex.h"
+
+#include <algorithm>
+
+#include <QRegularExpression>
+
+#include "../../global.h"
+#include "../rss_autodownloadrule.h"
+
+namespace
+{
+    // Returns the longest literal substring that must be present in any title
+    // matching the given wildcard token, or an empty string if there is none
+    QString tokenLiteral(const QString &token)
+    {
+        // Character sets and escapes aren't worth handling here
+        if (token.contains(QLatin1Char('[')) || token.contains(QLatin1Char('\\')))
+            return {};
+
+        QString literal;
+        const QStringList parts = token.split(QRegularExpression {QLatin1String("[*?]")}, QString::SkipEmptyParts);
+        for (const QString &part : parts) {
+            if (part.size() > literal.size())
+                literal = part;
+        }
+        return literal;
+    }
+
+    // Returns one required literal per "must contain" expression of the rule,
+    // or an empty list if the rule can't be prefiltered
+    QStringList requiredLiterals(const RSS::AutoDownloadRule &rule)
+    {
+        if (rule.useRegex())
+            return {};
+
+        const QString mustContain = rule.mustContain();
+        if (mustContain.isEmpty())
+            return {};
+
+        const QRegularExpression whitespace {QLatin1String("\\s+")};
+        QStringList literals;
+        for (const QString &expression : asConst(mustContain.split(QLatin1Char('|')))) {
+            // Every wildcard token of the expression must be present in the title,
+            // so the longest literal of any token is a necessary condition
+            QString literal;
+            for (const QString &token : asConst(expression.split(whitespace, QString::SkipEmptyParts))) {
+                const QString candidate = tokenLiteral(token);
+                if (candidate.size() > literal.size())
+                    literal = candidate;
+            }
+
+            // An expression without literals may match anything
+            if (literal.isEmpty())
+                return {};
+
+            literals << literal.toCaseFolded();
+        }
+
+        return literals;
+    }
+}
+
+using namespace RSS::Private;
+
+void RuleIndex::build(const QList<AutoDownloadRule> &rules)
+{
+    clear();
+
+    // Sort the rules to have a stable evaluation order
+    QList<AutoDownloadRule> sortedRules = rules;
+    std::sort(sortedRules.begin(), sortedRules.end()
+              , [](const AutoDownloadRule &left, const AutoDownloadRule &right)
+    {
+        return (left.name() < right.name());
+    });
+
+    for (const AutoDownloadRule &rule : asConst(sortedRules)) {
+        if (!rule.isEnabled()) continue;
+
+        const int ruleId = m_ruleNames.size();
+        m_ruleNames.append(rule.name());
+
+        const QStringList literals = requiredLiterals(rule);
+        m_needsPrefilter.append(!literals.isEmpty());
+        for (const QString &literal : literals)
+            addLiteral(literal, ruleId);
+
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+            m_rulesByFeed[feedURL].append(ruleId);
+    }
+
+    buildFailureLinks();
+}
+
+void RuleIndex::clear()
+{
+    m_nodes.clear();
+    m_nodes.append(Node {}); // root
+    m_ruleNames.clear();
+    m_needsPrefilter.clear();
+    m_rulesByFeed.clear();
+}
+
+QStringList RuleIndex::candidateRules(const QString &feedURL, const QString &articleTitle) const
+{
+    const QVector<int> ruleIds = m_rulesByFeed.value(feedURL);
+    if (ruleIds.isEmpty())
+        return {};
+
+    const bool needsScan = std::any_of(ruleIds.cbegin(), ruleIds.cend()
+                                       , [this](const int ruleId) { return m_needsPrefilter[ruleId]; });
+
+    QVector<bool> matched;
+    if (needsScan) {
+        matched.fill(false, m_ruleNames.size());
+
+        int state = 0;
+        for (const QChar c : asConst(articleTitle.toCaseFolded())) {
+            while ((state > 0) && !m_nodes[state].next.contains(c))
+                state = m_nodes[state].fail;
+            state = m_nodes[state].next.value(c, 0);
+
+            for (const int ruleId : m_nodes[state].outputs)
+                matched[ruleId] = true;
+        }
+    }
+
+    QStringList result;
+    for (const int ruleId : ruleIds) {
+        if (!m_needsPrefilter[ruleId] || matched[ruleId])
+            result.append(m_ruleNames[ruleId]);
+    }
+
+    return result;
+}
+
+void RuleIndex::addLiteral(const QString &literal, const int ruleId)
+{
+    int state = 0;
+    for (const QChar c : literal) {
+        int nextState = m_nodes[state].next.value(c, -1);
+        if (nextState < 0) {
+            nextState = m_nodes.size();
+            m_nodes[state].next.insert(c, nextState);
+            m_nodes.append(Node {});
+        }
+        state = nextState;
+    }
+
+    m_nodes[state].outputs.append(ruleId);
+}
+
+void RuleIndex::buildFailureLinks()
+{
+    // Breadth-first traversal, so the failure target of each node
+    // (which is always shallower) is complete when the node is visited
+    QVector<int> queue;
+    queue.reserve(m_nodes.size());
+    for (const int child : asConst(m_nodes[0].next))
+        queue.append(child);
+
+    for (int i = 0; i < queue.size(); ++i) {
+        const int state = queue[i];
+        const QHash<QChar, int> next = m_nodes[state].next;
+        for (auto it = next.cbegin(); it != next.cend(); ++it) {
+            const QChar c = it.key();
+            const int child = it.value();
+
+            int fail = m_nodes[state].fail;
+            while ((fail > 0) && !m_nodes[fail].next.contains(c))
+                fail = m_nodes[fail].fail;
+
+            m_nodes[child].fail = m_nodes[fail].next.value(c, 0);
+            m_nodes[child].outputs += m_nodes[m_nodes[child].fail].outputs;
+            queue.append(child);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace RSS
+{
+    class AutoDownloadRule;
+
+    namespace Private
+    {
+        // Narrows down the set of rules that need to be evaluated against an article.
+        // Rules are bucketed by feed URL, and the literal parts of their "must contain"
+        // wildcard expressions are combined into a single Aho-Corasick automaton, so
+        // an article title is scanned once regardless of the number of rules.
+        // Rules whose expressions have no usable literal (e.g. regex rules) are always
+        // reported as candidates. The index never rejects a rule that could match.
+        class RuleIndex
+        {
+        public:
+            void build(const QList<AutoDownloadRule> &rules);
+            void clear();
+
+            // Returns the names of the enabled rules that may accept the article.
+            QStringList candidateRules(const QString &feedURL, const QString &articleTitle) const;
+
+        private:
+            struct Node
+            {
+                QHash<QChar, int> next;
+                int fail = 0;
+                QVector<int> outputs; // rule ids
+            };
+
+            void addLiteral(const QString &literal, int ruleId);
+            void buildFailureLinks();
+
+            QVector<Node> m_nodes;
+            QVector<QString> m_ruleNames;
+            QVector<bool> m_needsPrefilter;
+            QHash<QString, QVector<int>> m_rulesByFeed;
+        };
+    }
+}
@@ -201,6 +201,7 @@ bool AutoDownloader::renameRule(const QString &ruleName, const QString &newRuleN
     if (hasRule(newRuleName)) return false;
 
     m_rules.insert(newRuleName, m_rules.take(ruleName));
+    m_isRuleIndexValid = false;
     m_dirty = true;
     store();
     emit ruleRenamed(newRuleName, ruleName);
@@ -212,6 +213,7 @@ void AutoDownloader::removeRule(const QString &ruleName)
     if (m_rules.contains(ruleName)) {
         emit ruleAboutToBeRemoved(ruleName);
         m_rules.remove(ruleName);
+        m_isRuleIndexValid = false;
         m_dirty = true;
         store();
     }
@@ -356,6 +358,7 @@ void AutoDownloader::handleNewArticle(const Article *article)
 void AutoDownloader::setRule_impl(const AutoDownloadRule &rule)
 {
     m_rules.insert(rule.name(), rule);
+    m_isRuleIndexValid = false;
 }
 
 void AutoDownloader::addJobForArticle(const Article *article)
@@ -373,9 +376,15 @@ void AutoDownloader::addJobForArticle(const Article *article)
 
 void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
 {
-    for (AutoDownloadRule &rule : m_rules) {
-        if (!rule.isEnabled()) continue;
-        if (!rule.feedURLs().contains(job->feedURL)) continue;
+    if (!m_isRuleIndexValid) {
+        m_ruleIndex.build(m_rules.values());
+        m_isRuleIndexValid = true;
+    }
+
+    // Only the rules that are assigned to the feed and may match the article title are evaluated
+    const QString articleTitle = job->articleData.value(Article::KeyTitle).toString();
+    for (const QString &ruleName : asConst(m_ruleIndex.candidateRules(job->feedURL, articleTitle))) {
+        AutoDownloadRule &rule = m_rules[ruleName];
         if (!rule.accepts(job->articleData)) continue;
 
         m_dirty = true;
@@ -38,6 +38,8 @@
 #include <QRegularExpression>
 #include <QSharedPointer>
 
+#include "private/rss_ruleindex.h"
+
 class QThread;
 class QTimer;
 
@@ -137,6 +139,8 @@ namespace RSS
         QThread *m_ioThread;
         AsyncFileStorage *m_fileStorage;
         QHash<QString, AutoDownloadRule> m_rules;
+        Private::RuleIndex m_ruleIndex;
+        bool m_isRuleIndexValid = false;
         QList<QSharedPointer<ProcessingJob>> m_processingQueue;
         QHash<QString, QSharedPointer<ProcessingJob>> m_waitingJobs;
         bool m_dirty = false;
@@ -58,6 +58,7 @@ const QString KEY_LASTBUILDDATE(QStringLiteral("lastBuildDate"));
 const QString KEY_ISLOADING(QStringLiteral("isLoading"));
 const QString KEY_HASERROR(QStringLiteral("hasError"));
 const QString KEY_ARTICLES(QStringLiteral("articles"));
+const QString KEY_READ(QStringLiteral("read"));
 
 using namespace RSS;
 
@@ -68,6 +69,8 @@ Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *s
     , m_url(url)
 {
     m_dataFileName = QString::fromLatin1(m_uid.toRfc4122().toHex()) + QLatin1String(".json");
+    // Changes made since the last full snapshot are appended to the journal
+    m_journalFileName = QString::fromLatin1(m_uid.toRfc4122().toHex()) + QLatin1String(".journal");
 
     // Move to new file naming scheme (since v4.1.2)
     const QString legacyFilename {Utils::Fs::toValidFileSystemName(m_url, false, QLatin1String("_"))
@@ -112,12 +115,12 @@ void Feed::markAsRead()
             article->disconnect(this);
             article->markAsRead();
             --m_unreadCount;
+            m_pendingReadGUIDs << article->guid();
             emit articleRead(article);
         }
     }
 
     if (m_unreadCount != oldUnreadCount) {
-        m_dirty = true;
         store();
         emit unreadCountChanged(this);
     }
@@ -195,7 +198,7 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
     if (result.status == Net::DownloadStatus::Success) {
         qDebug() << "Successfully downloaded RSS feed at" << result.url;
         // Parse the download RSS
-        m_parser->parse(result.data);
+        m_parser->parse(result.data, m_articles.keys());
     }
     else {
         m_isLoading = false;
@@ -214,14 +217,11 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
 
     if (!result.title.isEmpty() && (title() != result.title)) {
         m_title = result.title;
-        m_dirty = true;
         emit titleChanged(this);
     }
 
-    if (!result.lastBuildDate.isEmpty()) {
+    if (!result.lastBuildDate.isEmpty())
         m_lastBuildDate = result.lastBuildDate;
-        m_dirty = true;
-    }
 
     // For some reason, the RSS feed may contain malformed XML data and it may not be
     // successfully parsed by the XML parser. We are still trying to load as many articles
@@ -259,6 +259,19 @@ void Feed::load()
                .arg(m_dataFileName, file.errorString())
                , Log::WARNING);
     }
+
+    QFile journalFile(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_journalFileName));
+    if (journalFile.exists()) {
+        if (journalFile.open(QFile::ReadOnly)) {
+            loadJournal(journalFile.readAll());
+            journalFile.close();
+        }
+        else {
+            LogMsg(tr("Couldn't read RSS Session data from %1. Error: %2")
+                   .arg(m_journalFileName, journalFile.errorString())
+                   , Log::WARNING);
+        }
+    }
 }
 
 void Feed::loadArticles(const QByteArray &data)
@@ -315,18 +328,86 @@ void Feed::loadArticlesLegacy()
     }
 }
 
-void Feed::store()
+void Feed::loadJournal(const QByteArray &data)
 {
-    if (!m_dirty) return;
+    // Each line of the journal is either an article record or
+    // a list of GUIDs of the articles that were marked as read
+    const QList<QByteArray> records = data.split('\n');
+    for (const QByteArray &record : records) {
+        if (record.isEmpty()) continue;
 
-    m_dirty = false;
+        QJsonParseError jsonError;
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(record, &jsonError);
+        if ((jsonError.error != QJsonParseError::NoError) || !jsonDoc.isObject()) {
+            // Most likely the last record was truncated, so rewrite the whole data
+            LogMsg(tr("Couldn't load RSS article journal record of '%1'. Invalid data format.").arg(m_url)
+                   , Log::WARNING);
+            m_dirty = true;
+            continue;
+        }
+
+        ++m_journalRecordCount;
+
+        const QJsonObject jsonObj = jsonDoc.object();
+        if (jsonObj.contains(KEY_READ)) {
+            for (const QJsonValue &guid : asConst(jsonObj.value(KEY_READ).toArray())) {
+                Article *article = m_articles.value(guid.toString());
+                if (article && !article->isRead()) {
+                    article->disconnect(this);
+                    article->markAsRead();
+                    --m_unreadCount;
+                }
+            }
+            continue;
+        }
+
+        try {
+            auto article = new Article(this, jsonObj);
+            // The record may be already included in the snapshot if the journal
+            // wasn't truncated after the last compaction
+            if (m_articles.contains(article->guid()) || !addArticle(article))
+                delete article;
+        }
+        catch (const std::runtime_error&) {}
+    }
+}
+
+void Feed::store()
+{
     m_savingTimer.stop();
 
-    QJsonArray jsonArr;
-    for (Article *article :asConst(m_articles))
-        jsonArr << article->toJsonObject();
+    if (!m_pendingReadGUIDs.isEmpty()) {
+        appendJournalRecord(QJsonObject {{KEY_READ, QJsonArray::fromStringList(m_pendingReadGUIDs)}});
+        m_pendingReadGUIDs.clear();
+    }
+
+    // Compact the journal once it holds as many records as the feed holds articles
+    if (m_journalRecordCount >= m_session->maxArticlesPerFeed())
+        m_dirty = true;
+
+    if (m_dirty) {
+        m_dirty = false;
+        m_pendingJournalData.clear();
+        m_journalRecordCount = 0;
+
+        QJsonArray jsonArr;
+        for (Article *article : asConst(m_articles))
+            jsonArr << article->toJsonObject();
+
+        m_session->dataFileStorage()->store(m_dataFileName, QJsonDocument(jsonArr).toJson());
+        m_session->dataFileStorage()->store(m_journalFileName, {});
+    }
+    else if (!m_pendingJournalData.isEmpty()) {
+        m_session->dataFileStorage()->append(m_journalFileName, m_pendingJournalData);
+        m_pendingJournalData.clear();
+    }
+}
 
-    m_session->dataFileStorage()->store(m_dataFileName, QJsonDocument(jsonArr).toJson());
+void Feed::appendJournalRecord(const QJsonObject &record)
+{
+    m_pendingJournalData += QJsonDocument(record).toJson(QJsonDocument::Compact);
+    m_pendingJournalData += '\n';
+    ++m_journalRecordCount;
 }
 
 void Feed::storeDeferred()
@@ -354,7 +435,6 @@ bool Feed::addArticle(Article *article)
         connect(article, &Article::read, this, &Feed::handleArticleRead);
     }
 
-    m_dirty = true;
     emit newArticle(article);
 
     if (m_articlesByDate.size() > maxArticles)
@@ -420,6 +500,11 @@ int Feed::updateArticles(const QList<QVariantHash> &loadedArticles)
             continue;
         }
 
+        // The parser passes only the ID of an article that was known when parsing started.
+        // If the article has been removed since then, there's nothing to add.
+        if (article.size() == 1)
+            continue;
+
         QVariant &articleDate = article[Article::KeyDate];
         if (!articleDate.toDateTime().isValid())
             articleDate = dummyPubDate;
@@ -432,36 +517,43 @@ int Feed::updateArticles(const QList<QVariantHash> &loadedArticles)
 
     using ArticleSortAdaptor = QPair<QDateTime, const QVariantHash *>;
     std::vector<ArticleSortAdaptor> sortData;
-    const QList<Article *> existingArticles = articles();
-    sortData.reserve(existingArticles.size() + newArticles.size());
-    std::transform(existingArticles.begin(), existingArticles.end(), std::back_inserter(sortData)
-                   , [](const Article *article)
-    {
-        return qMakePair(article->date(), nullptr);
-    });
+    sortData.reserve(newArticles.size());
     std::transform(newArticles.begin(), newArticles.end(), std::back_inserter(sortData)
                    , [](const QVariantHash &article)
     {
         return qMakePair(article[Article::KeyDate].toDateTime(), &article);
     });
 
-    // Sort article list in reverse chronological order
-    std::sort(sortData.begin(), sortData.end()
-              , [](const ArticleSortAdaptor &a1, const ArticleSortAdaptor &a2)
+    // Sort new articles in reverse chronological order
+    std::stable_sort(sortData.begin(), sortData.end()
+                     , [](const ArticleSortAdaptor &a1, const ArticleSortAdaptor &a2)
     {
         return (a1.first > a2.first);
     });
 
-    if (sortData.size() > static_cast<uint>(m_session->maxArticlesPerFeed()))
-        sortData.resize(m_session->maxArticlesPerFeed());
+    // Merge them with the existing (already sorted) articles
+    // to find out which of them fit into the articles limit
+    const int maxArticles = m_session->maxArticlesPerFeed();
+    int existingCount = 0;
+    int acceptedCount = 0;
+    for (const ArticleSortAdaptor &a : sortData) {
+        while ((existingCount < m_articlesByDate.size())
+               && (m_articlesByDate.at(existingCount)->date() > a.first)) {
+            ++existingCount;
+        }
+
+        if ((existingCount + acceptedCount) >= maxArticles)
+            break;
+        ++acceptedCount;
+    }
 
     int newArticlesCount = 0;
-    std::for_each(sortData.crbegin(), sortData.crend(), [this, &newArticlesCount](const ArticleSortAdaptor &a)
+    std::for_each(sortData.crend() - acceptedCount, sortData.crend(), [this, &newArticlesCount](const ArticleSortAdaptor &a)
     {
-        if (a.second) {
-            addArticle(new Article {this, *a.second});
-            ++newArticlesCount;
-        }
+        auto article = new Article {this, *a.second};
+        appendJournalRecord(article->toJsonObject());
+        addArticle(article);
+        ++newArticlesCount;
     });
 
     return newArticlesCount;
@@ -508,13 +600,15 @@ void Feed::handleArticleRead(Article *article)
     decreaseUnreadCount();
     emit articleRead(article);
     // will be stored deferred
-    m_dirty = true;
+    m_pendingReadGUIDs << article->guid();
     storeDeferred();
 }
 
 void Feed::cleanup()
 {
-    Utils::Fs::forceRemove(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_dataFileName));
+    const QDir storageDir {m_session->dataFileStorage()->storageDir()};
+    Utils::Fs::forceRemove(storageDir.absoluteFilePath(m_dataFileName));
+    Utils::Fs::forceRemove(storageDir.absoluteFilePath(m_journalFileName));
 }
 
 void Feed::timerEvent(QTimerEvent *event)
@@ -33,6 +33,7 @@
 #include <QBasicTimer>
 #include <QHash>
 #include <QList>
+#include <QStringList>
 #include <QUuid>
 
 #include "rss_item.h"
@@ -101,8 +102,10 @@ namespace RSS
         void load();
         void loadArticles(const QByteArray &data);
         void loadArticlesLegacy();
+        void loadJournal(const QByteArray &data);
         void store();
         void storeDeferred();
+        void appendJournalRecord(const QJsonObject &record);
         bool addArticle(Article *article);
         void removeOldestArticle();
         void increaseUnreadCount();
@@ -123,6 +126,10 @@ namespace RSS
         int m_unreadCount = 0;
         QString m_iconPath;
         QString m_dataFileName;
+        QString m_journalFileName;
+        QByteArray m_pendingJournalData;
+        QStringList m_pendingReadGUIDs;
+        int m_journalRecordCount = 0;
         QBasicTimer m_savingTimer;
         bool m_dirty = false;
     };
@@ -221,7 +221,8 @@ ScanFoldersModel::PathStatus ScanFoldersModel::addPath(const QString &watchPath,
 
     if (!m_fsWatcher) {
         m_fsWatcher = new FileSystemWatcher(this);
-        connect(m_fsWatcher, &FileSystemWatcher::torrentsAdded, this, &ScanFoldersModel::addTorrentsToSession);
+        connect(m_fsWatcher, &FileSystemWatcher::magnetFilesAdded, this, &ScanFoldersModel::addMagnetFilesToSession);
+        connect(m_fsWatcher, &FileSystemWatcher::torrentAdded, this, &ScanFoldersModel::addTorrentToSession);
     }
 
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
@@ -349,44 +350,46 @@ void ScanFoldersModel::configure()
     }
 }
 
-void ScanFoldersModel::addTorrentsToSession(const QStringList &pathList)
+BitTorrent::AddTorrentParams ScanFoldersModel::addTorrentParams(const QString &filePath) const
+{
+    BitTorrent::AddTorrentParams params;
+    if (downloadInWatchFolder(filePath))
+        params.savePath = QFileInfo(filePath).dir().path();
+    else if (!downloadInDefaultFolder(filePath))
+        params.savePath = downloadPathTorrentFolder(filePath);
+    return params;
+}
+
+void ScanFoldersModel::addMagnetFilesToSession(const QStringList &pathList)
 {
     for (const QString &file : pathList) {
         qDebug("File %s added", qUtf8Printable(file));
 
-        BitTorrent::AddTorrentParams params;
-        if (downloadInWatchFolder(file))
-            params.savePath = QFileInfo(file).dir().path();
-        else if (!downloadInDefaultFolder(file))
-            params.savePath = downloadPathTorrentFolder(file);
-
-        if (file.endsWith(".magnet")) {
-            QFile f(file);
-            if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream str(&f);
-                while (!str.atEnd())
-                    BitTorrent::Session::instance()->addTorrent(str.readLine(), params);
-
-                f.close();
-                Utils::Fs::forceRemove(file);
-            }
-            else {
-                qDebug("Failed to open magnet file: %s", qUtf8Printable(f.errorString()));
-            }
+        const BitTorrent::AddTorrentParams params = addTorrentParams(file);
+        QFile f(file);
+        if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream str(&f);
+            while (!str.atEnd())
+                BitTorrent::Session::instance()->addTorrent(str.readLine(), params);
+
+            f.close();
+            Utils::Fs::forceRemove(file);
         }
         else {
-            const BitTorrent::TorrentInfo torrentInfo = BitTorrent::TorrentInfo::loadFromFile(file);
-            if (torrentInfo.isValid()) {
-                BitTorrent::Session::instance()->addTorrent(torrentInfo, params);
-                Utils::Fs::forceRemove(file);
-            }
-            else {
-                qDebug("Ignoring incomplete torrent file: %s", qUtf8Printable(file));
-            }
+            qDebug("Failed to open magnet file: %s", qUtf8Printable(f.errorString()));
         }
     }
 }
 
+// The torrent file was already loaded by the watcher, it isn't read again here
+void ScanFoldersModel::addTorrentToSession(const QString &path, const BitTorrent::TorrentInfo &torrentInfo)
+{
+    qDebug("File %s added", qUtf8Printable(path));
+
+    BitTorrent::Session::instance()->addTorrent(torrentInfo, addTorrentParams(path));
+    Utils::Fs::forceRemove(path);
+}
+
 QString ScanFoldersModel::pathTypeDisplayName(const PathType type)
 {
     switch (type) {
@@ -36,6 +36,12 @@ class QStringList;
 
 class FileSystemWatcher;
 
+namespace BitTorrent
+{
+    struct AddTorrentParams;
+    class TorrentInfo;
+}
+
 class ScanFoldersModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -93,7 +99,8 @@ public slots:
     void configure();
 
 private slots:
-    void addTorrentsToSession(const QStringList &pathList);
+    void addMagnetFilesToSession(const QStringList &pathList);
+    void addTorrentToSession(const QString &path, const BitTorrent::TorrentInfo &torrentInfo);
 
 private:
     explicit ScanFoldersModel(QObject *parent = nullptr);
@@ -103,6 +110,7 @@ private:
     bool downloadInWatchFolder(const QString &filePath) const;
     bool downloadInDefaultFolder(const QString &filePath) const;
     QString downloadPathTorrentFolder(const QString &filePath) const;
+    BitTorrent::AddTorrentParams addTorrentParams(const QString &filePath) const;
     int findPathData(const QString &path) const;
 
     static ScanFoldersModel *m_instance;
@@ -29,42 +29,15 @@
 
 #include "settingsstorage.h"
 
-#include <memory>
-#include <QFile>
+#include <algorithm>
+
 #include <QHash>
+#include <QThread>
 
-#include "global.h"
-#include "logger.h"
-#include "profile.h"
-#include "utils/fs.h"
+#include "private/settingsstorage_p.h"
 
 namespace
 {
-    // Encapsulates serialization of settings in "atomic" way.
-    // write() does not leave half-written files,
-    // read() has a workaround for a case of power loss during a previous serialization
-    class TransactionalSettings
-    {
-    public:
-        explicit TransactionalSettings(const QString &name)
-            : m_name(name)
-        {
-        }
-
-        QVariantHash read();
-        bool write(const QVariantHash &data);
-
-    private:
-        // we return actual file names used by QSettings because
-        // there is no other way to get that name except
-        // actually create a QSettings object.
-        // if serialization operation was not successful we return empty string
-        QString deserialize(const QString &name, QVariantHash &data);
-        QString serialize(const QString &name, const QVariantHash &data);
-
-        const QString m_name;
-    };
-
     QString mapKey(const QString &key)
     {
         static const QHash<QString, QString> keyMapping = {
@@ -153,18 +126,31 @@ namespace
 SettingsStorage *SettingsStorage::m_instance = nullptr;
 
 SettingsStorage::SettingsStorage()
-    : m_data{TransactionalSettings(QLatin1String("qBittorrent")).read()}
-    , m_dirty(false)
+    : m_data{Private::TransactionalSettings(QLatin1String("qBittorrent")).read()}
+    , m_savedData(m_data)
+    , m_ioThread(new QThread(this))
+    , m_writer(new Private::SettingsWriter(QLatin1String("qBittorrent")))
     , m_lock(QReadWriteLock::Recursive)
 {
     m_timer.setSingleShot(true);
     m_timer.setInterval(5 * 1000);
     connect(&m_timer, &QTimer::timeout, this, &SettingsStorage::save);
+
+    m_writer->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    connect(m_writer, &Private::SettingsWriter::finished, this, &SettingsStorage::handleWriteFinished);
+    m_ioThread->start();
 }
 
 SettingsStorage::~SettingsStorage()
 {
-    save();
+    m_ioThread->quit();
+    m_ioThread->wait();
+
+    // Write the latest changes synchronously since the I/O thread is stopped
+    QWriteLocker locker(&m_lock);
+    if (!m_changedKeys.isEmpty() || m_writePending || m_writeInProgress)
+        Private::TransactionalSettings(QLatin1String("qBittorrent")).write(m_data);
 }
 
 void SettingsStorage::initInstance()
@@ -186,18 +172,59 @@ SettingsStorage *SettingsStorage::instance()
 
 bool SettingsStorage::save()
 {
-    if (!m_dirty) return false; // Obtaining the lock is expensive, let's check early
-    QWriteLocker locker(&m_lock);
-    if (!m_dirty) return false; // something might have changed while we were getting the lock
-
-    TransactionalSettings settings(QLatin1String("qBittorrent"));
-    if (settings.write(m_data)) {
-        m_dirty = false;
-        return true;
+    {
+        QWriteLocker locker(&m_lock);
+        if (!m_changedKeys.isEmpty()) {
+            // Keys which were changed back to their saved value don't need a write
+            const bool changed = std::any_of(m_changedKeys.cbegin(), m_changedKeys.cend(), [this](const QString &key)
+            {
+                const auto iter = m_data.constFind(key);
+                const auto savedIter = m_savedData.constFind(key);
+                if ((iter == m_data.cend()) || (savedIter == m_savedData.cend()))
+                    return ((iter == m_data.cend()) != (savedIter == m_savedData.cend()));
+                return (*iter != *savedIter);
+            });
+            m_changedKeys.clear();
+
+            if (changed) {
+                // the snapshot shares the data until the next change
+                m_savedData = m_data;
+                m_writePending = true;
+            }
+        }
     }
 
-    m_timer.start();
-    return false;
+    if (!m_writePending)
+        return false;
+
+    // A burst of saves during a write is coalesced into a single write of the latest snapshot
+    if (!m_writeInProgress)
+        writeSnapshot();
+    return true;
+}
+
+void SettingsStorage::writeSnapshot()
+{
+    m_writePending = false;
+    m_writeInProgress = true;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_writer, [writer = m_writer, data = m_savedData]() { writer->write(data); });
+#else
+    QMetaObject::invokeMethod(m_writer, "write", Q_ARG(QVariantHash, m_savedData));
+#endif
+}
+
+void SettingsStorage::handleWriteFinished(const bool success)
+{
+    m_writeInProgress = false;
+
+    if (!success) {
+        m_writePending = true;
+        m_timer.start();
+    }
+    else if (m_writePending) {
+        writeSnapshot();
+    }
 }
 
 QVariant SettingsStorage::loadValue(const QString &key, const QVariant &defaultValue) const
@@ -211,7 +238,7 @@ void SettingsStorage::storeValue(const QString &key, const QVariant &value)
     const QString realKey = mapKey(key);
     QWriteLocker locker(&m_lock);
     if (m_data.value(realKey) != value) {
-        m_dirty = true;
+        m_changedKeys.insert(realKey);
         m_data.insert(realKey, value);
         m_timer.start();
     }
@@ -222,97 +249,8 @@ void SettingsStorage::removeValue(const QString &key)
     const QString realKey = mapKey(key);
     QWriteLocker locker(&m_lock);
     if (m_data.contains(realKey)) {
-        m_dirty = true;
+        m_changedKeys.insert(realKey);
         m_data.remove(realKey);
         m_timer.start();
     }
 }
-
-QVariantHash TransactionalSettings::read()
-{
-    QVariantHash res;
-
-    const QString newPath = deserialize(m_name + QLatin1String("_new"), res);
-    if (!newPath.isEmpty()) { // "_new" file is NOT empty
-        // This means that the PC closed either due to power outage
-        // or because the disk was full. In any case the settings weren't transferred
-        // in their final position. So assume that qbittorrent_new.ini/qbittorrent_new.conf
-        // contains the most recent settings.
-        Logger::instance()->addMessage(QObject::tr("Detected unclean program exit. Using fallback file to restore settings: %1")
-                .arg(Utils::Fs::toNativePath(newPath))
-            , Log::WARNING);
-
-        QString finalPath = newPath;
-        int index = finalPath.lastIndexOf("_new", -1, Qt::CaseInsensitive);
-        finalPath.remove(index, 4);
-
-        Utils::Fs::forceRemove(finalPath);
-        QFile::rename(newPath, finalPath);
-    }
-    else {
-        deserialize(m_name, res);
-    }
-
-    return res;
-}
-
-bool TransactionalSettings::write(const QVariantHash &data)
-{
-    // QSettings deletes the file before writing it out. This can result in problems
-    // if the disk is full or a power outage occurs. Those events might occur
-    // between deleting the file and recreating it. This is a safety measure.
-    // Write everything to qBittorrent_new.ini/qBittorrent_new.conf and if it succeeds
-    // replace qBittorrent.ini/qBittorrent.conf with it.
-    const QString newPath = serialize(m_name + QLatin1String("_new"), data);
-    if (newPath.isEmpty()) {
-        Utils::Fs::forceRemove(newPath);
-        return false;
-    }
-
-    QString finalPath = newPath;
-    int index = finalPath.lastIndexOf("_new", -1, Qt::CaseInsensitive);
-    finalPath.remove(index, 4);
-
-    Utils::Fs::forceRemove(finalPath);
-    return QFile::rename(newPath, finalPath);
-}
-
-QString TransactionalSettings::deserialize(const QString &name, QVariantHash &data)
-{
-    SettingsPtr settings = Profile::instance().applicationSettings(name);
-
-    if (settings->allKeys().isEmpty())
-        return {};
-
-    // Copy everything into memory. This means even keys inserted in the file manually
-    // or that we don't touch directly in this code (eg disabled by ifdef). This ensures
-    // that they will be copied over when save our settings to disk.
-    for (const QString &key : asConst(settings->allKeys()))
-        data.insert(key, settings->value(key));
-
-    return settings->fileName();
-}
-
-QString TransactionalSettings::serialize(const QString &name, const QVariantHash &data)
-{
-    SettingsPtr settings = Profile::instance().applicationSettings(name);
-    for (auto i = data.begin(); i != data.end(); ++i)
-        settings->setValue(i.key(), i.value());
-
-    settings->sync(); // Important to get error status
-
-    switch (settings->status()) {
-    case QSettings::NoError:
-        return settings->fileName();
-    case QSettings::AccessError:
-        Logger::instance()->addMessage(QObject::tr("An access error occurred while trying to write the configuration file."), Log::CRITICAL);
-        break;
-    case QSettings::FormatError:
-        Logger::instance()->addMessage(QObject::tr("A format error occurred while trying to write the configuration file."), Log::CRITICAL);
-        break;
-    default:
-        Logger::instance()->addMessage(QObject::tr("An unknown error occurred while trying to write the configuration file."), Log::CRITICAL);
-        break;
-    }
-    return {};
-}
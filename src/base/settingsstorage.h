@@ -32,9 +32,17 @@
 
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QTimer>
 #include <QVariantHash>
 
+class QThread;
+
+namespace Private
+{
+    class SettingsWriter;
+}
+
 class SettingsStorage : public QObject
 {
     Q_OBJECT
@@ -51,13 +59,26 @@ public:
     void removeValue(const QString &key);
 
 public slots:
+    // Hands the changes over to the I/O thread, returns false if there is nothing to save
     bool save();
 
+private slots:
+    void handleWriteFinished(bool success);
+
 private:
+    void writeSnapshot();
+
     static SettingsStorage *m_instance;
 
     QVariantHash m_data;
-    bool m_dirty;
+    // keys changed since the last snapshot
+    QSet<QString> m_changedKeys;
+    // the last snapshot given to the writer, it shares the data with m_data until the next change
+    QVariantHash m_savedData;
+    bool m_writePending = false;
+    bool m_writeInProgress = false;
+    QThread *m_ioThread;
+    Private::SettingsWriter *m_writer;
     QTimer m_timer;
     mutable QReadWriteLock m_lock;
 };
@@ -70,6 +70,11 @@ enum AdvSettingsRows
     SAVE_RESUME_DATA_INTERVAL,
     CONFIRM_RECHECK_TORRENT,
     RECHECK_COMPLETED,
+    // actions run on torrent completion
+    COMPLETION_HOOK_MAX_JOBS,
+    COMPLETION_HOOK_MAX_RETRIES,
+    COMPLETION_HOOK_TIMEOUT,
+    COMPLETION_WEBHOOK_URL,
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
     UPDATE_CHECK,
 #endif
@@ -107,9 +112,18 @@ enum AdvSettingsRows
     OUTGOING_PORT_MAX,
     UTP_MIX_MODE,
     MULTI_CONNECTIONS_PER_IP,
+    // automatic peer banning
+    PEER_BAN_POLICY,
+    PEER_BAN_FAKE_PROGRESS,
+    PEER_BAN_LEECH_ONLY,
+    PEER_BAN_HASH_FAILURES,
+    PEER_BAN_DURATION,
+    PEER_BAN_BLOCKED_CLIENTS,
     // embedded tracker
     TRACKER_STATUS,
     TRACKER_PORT,
+    TRACKER_MAX_TORRENTS,
+    TRACKER_MAX_PEERS_PER_TORRENT,
     // seeding
     CHOKING_ALGORITHM,
     SEED_CHOKING_ALGORITHM,
@@ -184,6 +198,13 @@ void AdvancedSettings::saveAdvancedSettings()
     session->setUtpMixedMode(static_cast<BitTorrent::MixedModeAlgorithm>(m_comboBoxUtpMixedMode.currentIndex()));
     // multiple connections per IP
     session->setMultiConnectionsPerIpEnabled(m_checkBoxMultiConnectionsPerIp.isChecked());
+    // Automatic peer banning
+    session->setPeerBanPolicyEnabled(m_checkBoxPeerBanPolicy.isChecked());
+    session->setFakeProgressBanEnabled(m_checkBoxPeerBanFakeProgress.isChecked());
+    session->setLeechOnlyBanEnabled(m_checkBoxPeerBanLeechOnly.isChecked());
+    session->setPeerBanHashFailureLimit(m_spinBoxPeerBanHashFailures.value());
+    session->setPeerBanDuration(m_spinBoxPeerBanDuration.value());
+    session->setPeerBanBlockedClients(m_lineEditPeerBanBlockedClients.text().split(',', QString::SkipEmptyParts));
     // Recheck torrents on completion
     pref->recheckTorrentsOnCompletion(m_checkBoxRecheckCompleted.isChecked());
     // Transfer list refresh interval
@@ -227,8 +248,16 @@ void AdvancedSettings::saveAdvancedSettings()
     AddNewTorrentDialog::setSavePathHistoryLength(m_spinBoxSavePathHistoryLength.value());
     pref->setSpeedWidgetEnabled(m_checkBoxSpeedWidgetEnabled.isChecked());
 
+    // Torrent completion actions
+    pref->setCompletionHookMaxJobs(m_spinBoxCompletionHookMaxJobs.value());
+    pref->setCompletionHookMaxRetries(m_spinBoxCompletionHookMaxRetries.value());
+    pref->setCompletionHookTimeout(m_spinBoxCompletionHookTimeout.value());
+    pref->setCompletionWebhookURL(m_lineEditCompletionWebhookURL.text());
+
     // Tracker
     pref->setTrackerPort(m_spinBoxTrackerPort.value());
+    pref->setTrackerMaxTorrents(m_spinBoxTrackerMaxTorrents.value());
+    pref->setTrackerMaxPeersPerTorrent(m_spinBoxTrackerMaxPeersPerTorrent.value());
     session->setTrackerEnabled(m_checkBoxTrackerStatus.isChecked());
     // Choking algorithm
     session->setChokingAlgorithm(static_cast<BitTorrent::ChokingAlgorithm>(m_comboBoxChokingAlgorithm.currentIndex()));
@@ -437,9 +466,48 @@ void AdvancedSettings::loadAdvancedSettings()
     // multiple connections per IP
     m_checkBoxMultiConnectionsPerIp.setChecked(session->multiConnectionsPerIpEnabled());
     addRow(MULTI_CONNECTIONS_PER_IP, tr("Allow multiple connections from the same IP address"), &m_checkBoxMultiConnectionsPerIp);
+    // Automatic peer banning
+    m_checkBoxPeerBanPolicy.setChecked(session->isPeerBanPolicyEnabled());
+    addRow(PEER_BAN_POLICY, tr("Ban misbehaving peers automatically"), &m_checkBoxPeerBanPolicy);
+    m_checkBoxPeerBanFakeProgress.setChecked(session->isFakeProgressBanEnabled());
+    addRow(PEER_BAN_FAKE_PROGRESS, tr("Ban peers reporting fake progress"), &m_checkBoxPeerBanFakeProgress);
+    m_checkBoxPeerBanLeechOnly.setChecked(session->isLeechOnlyBanEnabled());
+    addRow(PEER_BAN_LEECH_ONLY, tr("Ban peers that never upload"), &m_checkBoxPeerBanLeechOnly);
+    m_spinBoxPeerBanHashFailures.setMinimum(0);
+    m_spinBoxPeerBanHashFailures.setMaximum(100);
+    m_spinBoxPeerBanHashFailures.setValue(session->peerBanHashFailureLimit());
+    m_spinBoxPeerBanHashFailures.setSpecialValueText(tr("Disabled"));
+    addRow(PEER_BAN_HASH_FAILURES, tr("Ban peers after hash failures"), &m_spinBoxPeerBanHashFailures);
+    m_spinBoxPeerBanDuration.setMinimum(0);
+    m_spinBoxPeerBanDuration.setMaximum(525600);
+    m_spinBoxPeerBanDuration.setValue(session->peerBanDuration());
+    m_spinBoxPeerBanDuration.setSuffix(tr(" min", " minutes"));
+    m_spinBoxPeerBanDuration.setSpecialValueText(tr("Permanent"));
+    addRow(PEER_BAN_DURATION, tr("Automatic ban duration"), &m_spinBoxPeerBanDuration);
+    m_lineEditPeerBanBlockedClients.setText(session->peerBanBlockedClients().join(','));
+    m_lineEditPeerBanBlockedClients.setToolTip(tr("Comma-separated client names or peer ID prefixes (e.g. -XL)"));
+    addRow(PEER_BAN_BLOCKED_CLIENTS, tr("Blocked clients"), &m_lineEditPeerBanBlockedClients);
     // Recheck completed torrents
     m_checkBoxRecheckCompleted.setChecked(pref->recheckTorrentsOnCompletion());
     addRow(RECHECK_COMPLETED, tr("Recheck torrents on completion"), &m_checkBoxRecheckCompleted);
+    // Torrent completion actions
+    m_spinBoxCompletionHookMaxJobs.setMinimum(1);
+    m_spinBoxCompletionHookMaxJobs.setMaximum(64);
+    m_spinBoxCompletionHookMaxJobs.setValue(pref->getCompletionHookMaxJobs());
+    addRow(COMPLETION_HOOK_MAX_JOBS, tr("Maximum concurrent torrent completion actions"), &m_spinBoxCompletionHookMaxJobs);
+    m_spinBoxCompletionHookMaxRetries.setMinimum(0);
+    m_spinBoxCompletionHookMaxRetries.setMaximum(10);
+    m_spinBoxCompletionHookMaxRetries.setValue(pref->getCompletionHookMaxRetries());
+    addRow(COMPLETION_HOOK_MAX_RETRIES, tr("Torrent completion action retries"), &m_spinBoxCompletionHookMaxRetries);
+    m_spinBoxCompletionHookTimeout.setMinimum(0);
+    m_spinBoxCompletionHookTimeout.setMaximum(86400);
+    m_spinBoxCompletionHookTimeout.setValue(pref->getCompletionHookTimeout());
+    m_spinBoxCompletionHookTimeout.setSuffix(tr(" s", " seconds"));
+    m_spinBoxCompletionHookTimeout.setSpecialValueText(tr("Disabled"));
+    addRow(COMPLETION_HOOK_TIMEOUT, tr("Torrent completion action timeout"), &m_spinBoxCompletionHookTimeout);
+    m_lineEditCompletionWebhookURL.setText(pref->getCompletionWebhookURL());
+    m_lineEditCompletionWebhookURL.setPlaceholderText(QLatin1String("http://localhost:8000/finished"));
+    addRow(COMPLETION_WEBHOOK_URL, tr("Webhook URL to call on torrent completion"), &m_lineEditCompletionWebhookURL);
     // Transfer list refresh interval
     m_spinBoxListRefresh.setMinimum(30);
     m_spinBoxListRefresh.setMaximum(99999);
@@ -510,6 +578,16 @@ void AdvancedSettings::loadAdvancedSettings()
     m_spinBoxTrackerPort.setMaximum(65535);
     m_spinBoxTrackerPort.setValue(pref->getTrackerPort());
     addRow(TRACKER_PORT, tr("Embedded tracker port"), &m_spinBoxTrackerPort);
+    // Tracker max torrents
+    m_spinBoxTrackerMaxTorrents.setMinimum(1);
+    m_spinBoxTrackerMaxTorrents.setMaximum(1000000);
+    m_spinBoxTrackerMaxTorrents.setValue(pref->getTrackerMaxTorrents());
+    addRow(TRACKER_MAX_TORRENTS, tr("Embedded tracker maximum torrents"), &m_spinBoxTrackerMaxTorrents);
+    // Tracker max peers per torrent
+    m_spinBoxTrackerMaxPeersPerTorrent.setMinimum(1);
+    m_spinBoxTrackerMaxPeersPerTorrent.setMaximum(100000);
+    m_spinBoxTrackerMaxPeersPerTorrent.setValue(pref->getTrackerMaxPeersPerTorrent());
+    addRow(TRACKER_MAX_PEERS_PER_TORRENT, tr("Embedded tracker maximum peers per torrent"), &m_spinBoxTrackerMaxPeersPerTorrent);
     // Choking algorithm
     m_comboBoxChokingAlgorithm.addItems({tr("Fixed slots"), tr("Upload rate based")});
     m_comboBoxChokingAlgorithm.setCurrentIndex(static_cast<int>(session->chokingAlgorithm()));
@@ -282,13 +282,15 @@ void PeerListWidget::banSelectedPeers()
         , tr("Are you sure you want to permanently ban the selected peers?"));
     if (btn != QMessageBox::Yes) return;
 
+    QStringList ips;
     const QModelIndexList selectedIndexes = selectionModel()->selectedRows();
     for (const QModelIndex &index : selectedIndexes) {
         const int row = m_proxyModel->mapToSource(index).row();
         const QString ip = m_listModel->item(row, PeerListDelegate::IP_HIDDEN)->text();
-        BitTorrent::Session::instance()->banIP(ip);
+        ips << ip;
         LogMsg(tr("Peer \"%1\" is manually banned").arg(ip));
     }
+    BitTorrent::Session::instance()->banIPs(ips);
     // Refresh list
     loadPeers(m_properties->getCurrentTorrent());
 }
@@ -28,12 +28,9 @@
 
 #include "statsdialog.h"
 
-#include <algorithm>
-
 #include "base/bittorrent/cachestatus.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/sessionstatus.h"
-#include "base/bittorrent/torrenthandle.h"
 #include "base/global.h"
 #include "base/utils/misc.h"
 #include "base/utils/string.h"
@@ -91,11 +88,7 @@ void StatsDialog::update()
     // to complete before it receives or sends any more data on the socket. It's a metric of how disk bound you are.
 
     // num_peers is not reliable (adds up peers, which didn't even overcome tcp handshake)
-    const auto torrents = BitTorrent::Session::instance()->torrents();
-    const quint32 peers = std::accumulate(torrents.cbegin(), torrents.cend(), 0, [](const quint32 acc, const BitTorrent::TorrentHandle *torrent)
-    {
-        return (acc + torrent->peersCount());
-    });
+    const qint64 peers = BitTorrent::Session::instance()->totalPeersCount();
 
     m_ui->labelWriteStarve->setText(QString("%1%")
                                     .arg(((ss.diskWriteQueue > 0) && (peers > 0))
@@ -109,6 +102,10 @@ void StatsDialog::update()
     m_ui->labelQueuedJobs->setText(QString::number(cs.jobQueueLength));
     m_ui->labelJobsTime->setText(tr("%1 ms", "18 milliseconds").arg(cs.averageJobTime));
     m_ui->labelQueuedBytes->setText(Utils::Misc::friendlyUnit(cs.queuedBytes));
+    // Disk throughput
+    m_ui->labelDiskReadRate->setText(Utils::Misc::friendlyUnit(cs.diskReadRate, true));
+    m_ui->labelDiskWriteRate->setText(Utils::Misc::friendlyUnit(cs.diskWriteRate, true));
+    m_ui->labelHashRate->setText(Utils::Misc::friendlyUnit(cs.hashRate, true));
 
     // Total connected peers
     m_ui->labelPeers->setText(QString::number(ss.peersCount));
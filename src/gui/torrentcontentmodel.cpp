@@ -29,10 +29,14 @@
 #include "torrentcontentmodel.h"
 
 #include <algorithm>
+#include <vector>
 
 #include <QFileIconProvider>
 #include <QFileInfo>
+#include <QHash>
 #include <QIcon>
+#include <QPair>
+#include <QSet>
 
 #if defined(Q_OS_WIN)
 #include <Windows.h>
@@ -222,13 +226,17 @@ void TorrentContentModel::updateFilesProgress(const QVector<qreal> &fp)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fp.size()) return;
 
-    emit layoutAboutToBeChanged();
-    for (int i = 0; i < fp.size(); ++i)
-        m_filesIndex[i]->setProgress(fp[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    QVector<TorrentContentModelItem *> changedFiles;
+    for (int i = 0; i < fp.size(); ++i) {
+        TorrentContentModelFile *fileItem = m_filesIndex[i];
+        if ((fileItem->size() == 0) || (fileItem->progress() == fp[i]))
+            continue;
+
+        fileItem->setProgress(fp[i]);
+        changedFiles.append(fileItem);
+    }
+
+    updateFolders(changedFiles);
 }
 
 void TorrentContentModel::updateFilesPriorities(const QVector<BitTorrent::DownloadPriority> &fprio)
@@ -250,12 +258,75 @@ void TorrentContentModel::updateFilesAvailability(const QVector<qreal> &fa)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fa.size()) return;
 
-    emit layoutAboutToBeChanged();
-    for (int i = 0; i < fa.size(); ++i)
-        m_filesIndex[i]->setAvailability(fa[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    QVector<TorrentContentModelItem *> changedFiles;
+    for (int i = 0; i < fa.size(); ++i) {
+        TorrentContentModelFile *fileItem = m_filesIndex[i];
+        if ((fileItem->size() == 0) || (fileItem->availability() == fa[i]))
+            continue;
+
+        fileItem->setAvailability(fa[i]);
+        changedFiles.append(fileItem);
+    }
+
+    updateFolders(changedFiles);
+}
+
+void TorrentContentModel::updateFolders(const QVector<TorrentContentModelItem *> &changedFiles)
+{
+    if (changedFiles.isEmpty()) return;
+
+    // Collect the folders affected by the changed files along with
+    // the range of changed rows within each parent folder
+    QHash<TorrentContentModelFolder *, QPair<int, int>> changedRows;
+    const auto markRowChanged = [&changedRows](const TorrentContentModelItem *item)
+    {
+        const auto it = changedRows.find(item->parent());
+        if (it == changedRows.end()) {
+            changedRows.insert(item->parent(), qMakePair(item->row(), item->row()));
+        }
+        else {
+            it->first = std::min(it->first, item->row());
+            it->second = std::max(it->second, item->row());
+        }
+    };
+
+    QSet<TorrentContentModelFolder *> dirtyFolders;
+    for (const TorrentContentModelItem *fileItem : changedFiles) {
+        markRowChanged(fileItem);
+
+        TorrentContentModelFolder *folder = fileItem->parent();
+        while (!folder->isRootItem() && !dirtyFolders.contains(folder)) {
+            dirtyFolders.insert(folder);
+            markRowChanged(folder);
+            folder = folder->parent();
+        }
+    }
+
+    // Update folders bottom-up so that each one aggregates already updated children
+    using FolderDepth = QPair<int, TorrentContentModelFolder *>;
+    std::vector<FolderDepth> sortedFolders;
+    sortedFolders.reserve(dirtyFolders.size());
+    for (TorrentContentModelFolder *folder : asConst(dirtyFolders)) {
+        int depth = 0;
+        for (const TorrentContentModelItem *item = folder; !item->isRootItem(); item = item->parent())
+            ++depth;
+        sortedFolders.emplace_back(depth, folder);
+    }
+    std::sort(sortedFolders.begin(), sortedFolders.end()
+              , [](const FolderDepth &left, const FolderDepth &right) { return (left.first > right.first); });
+
+    for (const FolderDepth &folderDepth : sortedFolders) {
+        folderDepth.second->updateProgress();
+        folderDepth.second->updateAvailability();
+    }
+
+    for (auto it = changedRows.cbegin(); it != changedRows.cend(); ++it) {
+        TorrentContentModelFolder *parentItem = it.key();
+        const QModelIndex parentIndex = (parentItem == m_rootItem)
+            ? QModelIndex {} : createIndex(parentItem->row(), 0, parentItem);
+        emit dataChanged(index(it->first, TorrentContentModelItem::COL_PROGRESS, parentIndex)
+                         , index(it->second, TorrentContentModelItem::COL_AVAILABILITY, parentIndex));
+    }
 }
 
 QVector<BitTorrent::DownloadPriority> TorrentContentModel::getFilePriorities() const
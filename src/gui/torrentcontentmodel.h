@@ -80,6 +80,8 @@ public slots:
     void selectNone();
 
 private:
+    void updateFolders(const QVector<TorrentContentModelItem *> &changedFiles);
+
     TorrentContentModelFolder *m_rootItem;
     QVector<TorrentContentModelFile *> m_filesIndex;
     QFileIconProvider *m_fileIconProvider;
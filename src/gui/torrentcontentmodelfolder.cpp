@@ -65,6 +65,7 @@ void TorrentContentModelFolder::deleteAllChildren()
     Q_ASSERT(isRootItem());
     qDeleteAll(m_childItems);
     m_childItems.clear();
+    m_childFolders.clear();
 }
 
 const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children() const
@@ -75,7 +76,10 @@ const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children()
 void TorrentContentModelFolder::appendChild(TorrentContentModelItem *item)
 {
     Q_ASSERT(item);
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
+    if (item->itemType() == FolderType)
+        m_childFolders.insert(item->name(), static_cast<TorrentContentModelFolder *>(item));
     // Update own size
     if (item->itemType() == FileType)
         increaseSize(item->size());
@@ -88,11 +92,14 @@ TorrentContentModelItem *TorrentContentModelFolder::child(int row) const
 
 TorrentContentModelFolder *TorrentContentModelFolder::childFolderWithName(const QString &name) const
 {
-    for (TorrentContentModelItem *child : asConst(m_childItems)) {
-        if ((child->itemType() == FolderType) && (child->name() == name))
-            return static_cast<TorrentContentModelFolder *>(child);
-    }
-    return nullptr;
+    return m_childFolders.value(name, nullptr);
+}
+
+void TorrentContentModelFolder::renameChildFolder(const QString &oldName, const QString &newName)
+{
+    TorrentContentModelFolder *folder = m_childFolders.take(oldName);
+    Q_ASSERT(folder);
+    m_childFolders.insert(newName, folder);
 }
 
 int TorrentContentModelFolder::childCount() const
@@ -141,6 +148,26 @@ void TorrentContentModelFolder::setPriority(BitTorrent::DownloadPriority newPrio
 }
 
 void TorrentContentModelFolder::recalculateProgress()
+{
+    for (TorrentContentModelItem *child : asConst(m_childItems)) {
+        if ((child->itemType() == FolderType) && (child->priority() != BitTorrent::DownloadPriority::Ignored))
+            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
+    }
+
+    updateProgress();
+}
+
+void TorrentContentModelFolder::recalculateAvailability()
+{
+    for (TorrentContentModelItem *child : asConst(m_childItems)) {
+        if ((child->itemType() == FolderType) && (child->priority() != BitTorrent::DownloadPriority::Ignored))
+            static_cast<TorrentContentModelFolder *>(child)->recalculateAvailability();
+    }
+
+    updateAvailability();
+}
+
+void TorrentContentModelFolder::updateProgress()
 {
     qreal tProgress = 0;
     qulonglong tSize = 0;
@@ -149,8 +176,6 @@ void TorrentContentModelFolder::recalculateProgress()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
         tProgress += child->progress() * child->size();
         tSize += child->size();
         tRemaining += child->remaining();
@@ -163,7 +188,7 @@ void TorrentContentModelFolder::recalculateProgress()
     }
 }
 
-void TorrentContentModelFolder::recalculateAvailability()
+void TorrentContentModelFolder::updateAvailability()
 {
     qreal tAvailability = 0;
     qulonglong tSize = 0;
@@ -172,8 +197,6 @@ void TorrentContentModelFolder::recalculateAvailability()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder*>(child)->recalculateAvailability();
         const qreal childAvailability = child->availability();
         if (childAvailability >= 0) { // -1 means "no data"
             tAvailability += childAvailability * child->size();
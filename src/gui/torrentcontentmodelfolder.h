@@ -29,6 +29,8 @@
 #ifndef TORRENTCONTENTMODELFOLDER_H
 #define TORRENTCONTENTMODELFOLDER_H
 
+#include <QHash>
+
 #include "torrentcontentmodelitem.h"
 
 namespace BitTorrent
@@ -52,6 +54,9 @@ public:
     void increaseSize(qulonglong delta);
     void recalculateProgress();
     void recalculateAvailability();
+    // Unlike the recalculate*() functions these only aggregate the direct children
+    void updateProgress();
+    void updateAvailability();
     void updatePriority();
 
     void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
@@ -61,10 +66,12 @@ public:
     void appendChild(TorrentContentModelItem *item);
     TorrentContentModelItem *child(int row) const;
     TorrentContentModelFolder *childFolderWithName(const QString &name) const;
+    void renameChildFolder(const QString &oldName, const QString &newName);
     int childCount() const;
 
 private:
     QVector<TorrentContentModelItem*> m_childItems;
+    QHash<QString, TorrentContentModelFolder *> m_childFolders;
 };
 
 #endif // TORRENTCONTENTMODELFOLDER_H
@@ -34,6 +34,7 @@
 
 TorrentContentModelItem::TorrentContentModelItem(TorrentContentModelFolder *parent)
     : m_parentItem(parent)
+    , m_row(0)
     , m_size(0)
     , m_remaining(0)
     , m_priority(BitTorrent::DownloadPriority::Normal)
@@ -58,6 +59,8 @@ QString TorrentContentModelItem::name() const
 void TorrentContentModelItem::setName(const QString &name)
 {
     Q_ASSERT(!isRootItem());
+    if (itemType() == FolderType)
+        m_parentItem->renameChildFolder(m_name, name);
     m_name = name;
 }
 
@@ -125,9 +128,7 @@ QVariant TorrentContentModelItem::data(int column) const
 
 int TorrentContentModelItem::row() const
 {
-    if (m_parentItem)
-        return m_parentItem->children().indexOf(const_cast<TorrentContentModelItem *>(this));
-    return 0;
+    return m_row;
 }
 
 TorrentContentModelFolder *TorrentContentModelItem::parent() const
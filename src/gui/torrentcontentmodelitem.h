@@ -39,6 +39,8 @@ class TorrentContentModelFolder;
 
 class TorrentContentModelItem
 {
+    friend class TorrentContentModelFolder;
+
 public:
     enum TreeItemColumns
     {
@@ -82,6 +84,8 @@ public:
 
 protected:
     TorrentContentModelFolder *m_parentItem;
+    // Position in the parent's children list, assigned when appended to the parent
+    int m_row;
     // Root item members
     QVector<QVariant> m_itemData;
     // Non-root item members
@@ -35,6 +35,7 @@
 #include <QPainter>
 #include <QScrollArea>
 #include <QStyleOptionButton>
+#include <QTimer>
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -218,7 +219,17 @@ TrackerFiltersList::TrackerFiltersList(QWidget *parent, TransferListWidget *tran
     : BaseFilterWidget(parent, transferList)
     , m_totalTorrents(0)
     , m_downloadTrackerFavicon(downloadFavicon)
+    , m_updateTimer(new QTimer(this))
 {
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(BitTorrent::Session::instance()->refreshInterval());
+    connect(m_updateTimer, &QTimer::timeout, this, &TrackerFiltersList::processScheduledUpdate);
+    // the refresh interval is set with the other preferences
+    connect(Preferences::instance(), &Preferences::changed, this, [this]()
+    {
+        m_updateTimer->setInterval(BitTorrent::Session::instance()->refreshInterval());
+    });
+
     auto *allTrackers = new QListWidgetItem(this);
     allTrackers->setData(Qt::DisplayRole, QVariant(tr("All (0)", "this is for the tracker filter")));
     allTrackers->setData(Qt::DecorationRole, UIThemeManager::instance()->getIcon("network-server"));
@@ -231,7 +242,7 @@ TrackerFiltersList::TrackerFiltersList(QWidget *parent, TransferListWidget *tran
     auto *warningTracker = new QListWidgetItem(this);
     warningTracker->setData(Qt::DisplayRole, QVariant(tr("Warning (0)")));
     warningTracker->setData(Qt::DecorationRole, style()->standardIcon(QStyle::SP_MessageBoxWarning));
-    m_trackers.insert("", QStringList());
+    m_trackers.insert("", {});
 
     setCurrentRow(0, QItemSelectionModel::SelectCurrent);
     toggleFilter(Preferences::instance()->getTrackerFilterState());
@@ -245,14 +256,12 @@ TrackerFiltersList::~TrackerFiltersList()
 
 void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
 {
-    QStringList tmp;
     QListWidgetItem *trackerItem = nullptr;
-    QString host = getHost(tracker);
-    bool exists = m_trackers.contains(host);
+    const QString host = getHost(tracker);
+    const bool exists = m_trackers.contains(host);
 
     if (exists) {
-        tmp = m_trackers.value(host);
-        if (tmp.contains(hash))
+        if (m_trackers[host].contains(hash))
             return;
 
         if (host != "") {
@@ -271,19 +280,17 @@ void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
     }
     if (!trackerItem) return;
 
-    tmp.append(hash);
-    m_trackers.insert(host, tmp);
+    QSet<QString> &hashes = m_trackers[host];
+    hashes.insert(hash);
     if (host == "") {
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
-        if (currentRow() == 1)
-            applyFilter(1);
+        trackerItem->setText(tr("Trackerless (%1)").arg(hashes.size()));
+        scheduleUpdate(1);
         return;
     }
 
-    trackerItem->setText(QString("%1 (%2)").arg(host).arg(tmp.size()));
+    trackerItem->setText(QString("%1 (%2)").arg(host).arg(hashes.size()));
     if (exists) {
-        if (currentRow() == rowFromTracker(host))
-            applyFilter(currentRow());
+        scheduleUpdate(rowFromTracker(host));
         return;
     }
 
@@ -301,21 +308,21 @@ void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
 
 void TrackerFiltersList::removeItem(const QString &tracker, const QString &hash)
 {
-    QString host = getHost(tracker);
+    const QString host = getHost(tracker);
+    const auto hashesIter = m_trackers.find(host);
+    if ((hashesIter == m_trackers.end()) || !hashesIter->remove(hash))
+        return;
+
+    const int hashesCount = hashesIter->size();
     QListWidgetItem *trackerItem = nullptr;
-    QStringList tmp = m_trackers.value(host);
     int row = 0;
 
-    if (tmp.empty())
-        return;
-    tmp.removeAll(hash);
-
     if (!host.isEmpty()) {
         // Remove from 'Error' and 'Warning' view
         trackerSuccess(hash, tracker);
         row = rowFromTracker(host);
         trackerItem = item(row);
-        if (tmp.empty()) {
+        if (hashesCount == 0) {
             if (currentRow() == row)
                 setCurrentRow(0, QItemSelectionModel::SelectCurrent);
             delete trackerItem;
@@ -324,17 +331,15 @@ void TrackerFiltersList::removeItem(const QString &tracker, const QString &hash)
             return;
         }
         if (trackerItem != nullptr)
-            trackerItem->setText(QString("%1 (%2)").arg(host).arg(tmp.size()));
+            trackerItem->setText(QString("%1 (%2)").arg(host).arg(hashesCount));
     }
     else {
         row = 1;
         trackerItem = item(1);
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
+        trackerItem->setText(tr("Trackerless (%1)").arg(hashesCount));
     }
 
-    m_trackers.insert(host, tmp);
-    if (currentRow() == row)
-        applyFilter(row);
+    scheduleUpdate(row);
 }
 
 void TrackerFiltersList::changeTrackerless(bool trackerless, const QString &hash)
@@ -364,64 +369,61 @@ void TrackerFiltersList::setDownloadTrackerFavicon(bool value)
 
 void TrackerFiltersList::trackerSuccess(const QString &hash, const QString &tracker)
 {
-    QStringList errored = m_errors.value(hash);
-    QStringList warned = m_warnings.value(hash);
-
-    if (errored.contains(tracker)) {
-        errored.removeAll(tracker);
-        if (errored.empty()) {
-            m_errors.remove(hash);
-            item(2)->setText(tr("Error (%1)").arg(m_errors.size()));
-            if (currentRow() == 2)
-                applyFilter(2);
-        }
-        else {
-            m_errors.insert(hash, errored);
-        }
+    const auto errorsIter = m_errors.find(hash);
+    if ((errorsIter != m_errors.end()) && errorsIter->remove(tracker) && errorsIter->isEmpty()) {
+        m_errors.erase(errorsIter);
+        scheduleUpdate(2);
     }
 
-    if (warned.contains(tracker)) {
-        warned.removeAll(tracker);
-        if (warned.empty()) {
-            m_warnings.remove(hash);
-            item(3)->setText(tr("Warning (%1)").arg(m_warnings.size()));
-            if (currentRow() == 3)
-                applyFilter(3);
-        }
-        else {
-            m_warnings.insert(hash, warned);
-        }
+    const auto warningsIter = m_warnings.find(hash);
+    if ((warningsIter != m_warnings.end()) && warningsIter->remove(tracker) && warningsIter->isEmpty()) {
+        m_warnings.erase(warningsIter);
+        scheduleUpdate(3);
     }
 }
 
 void TrackerFiltersList::trackerError(const QString &hash, const QString &tracker)
 {
-    QStringList trackers = m_errors.value(hash);
-
+    QSet<QString> &trackers = m_errors[hash];
     if (trackers.contains(tracker))
         return;
 
-    trackers.append(tracker);
-    m_errors.insert(hash, trackers);
-    item(2)->setText(tr("Error (%1)").arg(m_errors.size()));
-
-    if (currentRow() == 2)
-        applyFilter(2);
+    trackers.insert(tracker);
+    // The filter only depends on which torrents have errors
+    if (trackers.size() == 1)
+        scheduleUpdate(2);
 }
 
 void TrackerFiltersList::trackerWarning(const QString &hash, const QString &tracker)
 {
-    QStringList trackers = m_warnings.value(hash);
-
+    QSet<QString> &trackers = m_warnings[hash];
     if (trackers.contains(tracker))
         return;
 
-    trackers.append(tracker);
-    m_warnings.insert(hash, trackers);
+    trackers.insert(tracker);
+    // The filter only depends on which torrents have warnings
+    if (trackers.size() == 1)
+        scheduleUpdate(3);
+}
+
+void TrackerFiltersList::scheduleUpdate(const int row)
+{
+    if (row == currentRow())
+        m_isCurrentRowDirty = true;
+
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void TrackerFiltersList::processScheduledUpdate()
+{
+    item(2)->setText(tr("Error (%1)").arg(m_errors.size()));
     item(3)->setText(tr("Warning (%1)").arg(m_warnings.size()));
 
-    if (currentRow() == 3)
-        applyFilter(3);
+    if (m_isCurrentRowDirty) {
+        m_isCurrentRowDirty = false;
+        applyFilter(currentRow());
+    }
 }
 
 void TrackerFiltersList::downloadFavicon(const QString &url)
@@ -555,13 +557,13 @@ QString TrackerFiltersList::getHost(const QString &tracker) const
 QStringList TrackerFiltersList::getHashes(int row)
 {
     if (row == 1)
-        return m_trackers.value("");
+        return m_trackers.value("").toList();
     if (row == 2)
         return m_errors.keys();
     if (row == 3)
         return m_warnings.keys();
 
-     return m_trackers.value(trackerFromRow(row));
+    return m_trackers.value(trackerFromRow(row)).toList();
 }
 
 TransferListFiltersWidget::TransferListFiltersWidget(QWidget *parent, TransferListWidget *transferList, const bool downloadFavicon)
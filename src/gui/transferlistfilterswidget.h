@@ -30,10 +30,13 @@
 #define TRANSFERLISTFILTERSWIDGET_H
 
 #include <QFrame>
+#include <QHash>
 #include <QListWidget>
+#include <QSet>
 
 class QCheckBox;
 class QResizeEvent;
+class QTimer;
 
 class TransferListWidget;
 
@@ -115,6 +118,7 @@ public slots:
 
 private slots:
     void handleFavicoDownloadFinished(const Net::DownloadResult &result);
+    void processScheduledUpdate();
 
 private:
     // These 4 methods are virtual slots in the base class.
@@ -128,13 +132,17 @@ private:
     QString getHost(const QString &tracker) const;
     QStringList getHashes(int row);
     void downloadFavicon(const QString &url);
+    void scheduleUpdate(int row);
 
-    QHash<QString, QStringList> m_trackers;
-    QHash<QString, QStringList> m_errors;
-    QHash<QString, QStringList> m_warnings;
+    QHash<QString, QSet<QString>> m_trackers; // host -> torrent hashes
+    QHash<QString, QSet<QString>> m_errors; // torrent hash -> trackers
+    QHash<QString, QSet<QString>> m_warnings; // torrent hash -> trackers
     QStringList m_iconPaths;
     int m_totalTorrents;
     bool m_downloadTrackerFavicon;
+    // Tracker status changes are applied at most once per session refresh interval
+    QTimer *m_updateTimer;
+    bool m_isCurrentRowDirty = false;
 };
 
 class CategoryFilterWidget;
@@ -41,11 +41,13 @@ APIController::APIController(ISessionManager *sessionManager, QObject *parent)
 {
 }
 
-QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data)
+QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data, const QVariant &asyncResult)
 {
     m_result.clear(); // clear result
+    m_asyncTask = {};
     m_params = params;
     m_data = data;
+    m_asyncResult = asyncResult;
 
     const QByteArray methodName = action.toLatin1() + "Action";
     if (!QMetaObject::invokeMethod(this, methodName.constData()))
@@ -54,6 +56,13 @@ QVariant APIController::run(const QString &action, const StringMap &params, cons
     return m_result;
 }
 
+APIController::AsyncTask APIController::takeAsyncTask()
+{
+    AsyncTask task = m_asyncTask;
+    m_asyncTask = {};
+    return task;
+}
+
 ISessionManager *APIController::sessionManager() const
 {
     return m_sessionManager;
@@ -95,3 +104,16 @@ void APIController::setResult(const QJsonObject &result)
 {
     m_result = QJsonDocument(result);
 }
+
+void APIController::runAsync(const AsyncJob &job, const AsyncTimeoutPolicy timeoutPolicy
+    , const std::function<void ()> &finishedHandler)
+{
+    // an action can only be deferred once
+    Q_ASSERT(!m_asyncResult.isValid());
+    m_asyncTask = {job, timeoutPolicy, finishedHandler};
+}
+
+const QVariant &APIController::asyncResult() const
+{
+    return m_asyncResult;
+}
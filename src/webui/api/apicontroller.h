@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <QHash>
 #include <QObject>
 #include <QSet>
@@ -51,9 +53,28 @@ class APIController : public QObject
 #endif
 
 public:
+    using AsyncJob = std::function<QVariant ()>;
+
+    // What becomes of a job whose request times out before the job is done
+    enum class AsyncTimeoutPolicy
+    {
+        Cancel,   // the action isn't re-run, so it has no effect
+        Complete  // the action is re-run anyway, only its response is lost
+    };
+
+    struct AsyncTask
+    {
+        AsyncJob job;
+        AsyncTimeoutPolicy timeoutPolicy = AsyncTimeoutPolicy::Cancel;
+        // Invoked on the controller's thread once the job is over, whatever
+        // happens to the request afterwards
+        std::function<void ()> finishedHandler;
+    };
+
     explicit APIController(ISessionManager *sessionManager, QObject *parent = nullptr);
 
-    QVariant run(const QString &action, const StringMap &params, const DataMap &data = {});
+    QVariant run(const QString &action, const StringMap &params, const DataMap &data = {}, const QVariant &asyncResult = {});
+    AsyncTask takeAsyncTask();
 
     ISessionManager *sessionManager() const;
 
@@ -66,9 +87,20 @@ protected:
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
 
+    // Lets an action do its heavy work on a worker thread: `job` must not touch
+    // the controller. Once it has finished, the action is invoked again with the
+    // same parameters and asyncResult() returning the value produced by `job`.
+    // The re-run may not happen (e.g. the request is rejected before reaching
+    // the controller), so per-job state must be released in `finishedHandler`.
+    void runAsync(const AsyncJob &job, AsyncTimeoutPolicy timeoutPolicy = AsyncTimeoutPolicy::Cancel
+        , const std::function<void ()> &finishedHandler = {});
+    const QVariant &asyncResult() const;
+
 private:
     ISessionManager *m_sessionManager;
     StringMap m_params;
     DataMap m_data;
     QVariant m_result;
+    QVariant m_asyncResult;
+    AsyncTask m_asyncTask;
 };
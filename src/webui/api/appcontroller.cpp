@@ -31,6 +31,7 @@
 #include "appcontroller.h"
 
 #include <algorithm>
+#include <limits>
 
 #include <QCoreApplication>
 #include <QDebug>
@@ -43,6 +44,7 @@
 #include <QTimer>
 #include <QTranslator>
 
+#include "base/bittorrent/bandwidthscheduleslot.h"
 #include "base/bittorrent/session.h"
 #include "base/global.h"
 #include "base/net/portforwarder.h"
@@ -57,6 +59,7 @@
 #include "base/utils/net.h"
 #include "base/utils/password.h"
 #include "../webapplication.h"
+#include "apierror.h"
 
 void AppController::webapiVersionAction()
 {
@@ -166,6 +169,13 @@ void AppController::preferencesAction()
     data["ip_filter_path"] = Utils::Fs::toNativePath(session->IPFilterFile());
     data["ip_filter_trackers"] = session->isTrackerFilteringEnabled();
     data["banned_IPs"] = session->bannedIPs().join("\n");
+    // Automatic peer banning
+    data["peer_ban_enabled"] = session->isPeerBanPolicyEnabled();
+    data["peer_ban_fake_progress"] = session->isFakeProgressBanEnabled();
+    data["peer_ban_leech_only"] = session->isLeechOnlyBanEnabled();
+    data["peer_ban_blocked_clients"] = session->peerBanBlockedClients().join("\n");
+    data["peer_ban_hash_failure_limit"] = session->peerBanHashFailureLimit();
+    data["peer_ban_duration"] = session->peerBanDuration();
 
     // Speed
     // Global Rate Limits
@@ -186,6 +196,11 @@ void AppController::preferencesAction()
     data["schedule_to_hour"] = end_time.hour();
     data["schedule_to_min"] = end_time.minute();
     data["scheduler_days"] = pref->getSchedulerDays();
+    QVariantList schedulerSlots;
+    for (const BitTorrent::BandwidthScheduleSlot &slot : asConst(session->bandwidthSchedule()))
+        schedulerSlots << slot.toVariantMap();
+    data["scheduler_slots"] = schedulerSlots;
+    data["scheduler_adaptive_upload"] = session->isAdaptiveUploadEnabled();
 
     // Bittorrent
     // Privacy
@@ -233,6 +248,7 @@ void AppController::preferencesAction()
         authSubnetWhitelistStringList << Utils::Net::subnetToString(subnet);
     data["bypass_auth_subnet_whitelist"] = authSubnetWhitelistStringList.join("\n");
     data["web_ui_session_timeout"] = pref->getWebUISessionTimeout();
+    data["web_ui_io_threads"] = pref->getWebUIIOThreadCount();
     // Use alternative Web UI
     data["alternative_webui_enabled"] = pref->isAltWebUiEnabled();
     data["alternative_webui_path"] = pref->getWebUiRootFolder();
@@ -265,6 +281,11 @@ void AppController::preferencesAction()
     data["save_resume_data_interval"] = static_cast<double>(session->saveResumeDataInterval());
     // Recheck completed torrents
     data["recheck_completed_torrents"] = pref->recheckTorrentsOnCompletion();
+    // Torrent completion actions
+    data["completion_hook_max_jobs"] = pref->getCompletionHookMaxJobs();
+    data["completion_hook_max_retries"] = pref->getCompletionHookMaxRetries();
+    data["completion_hook_timeout"] = pref->getCompletionHookTimeout();
+    data["completion_webhook_url"] = pref->getCompletionWebhookURL();
     // Resolve peer countries
     data["resolve_peer_countries"] = pref->resolvePeerCountries();
 
@@ -300,6 +321,8 @@ void AppController::preferencesAction()
     // Embedded tracker
     data["enable_embedded_tracker"] = session->isTrackerEnabled();
     data["embedded_tracker_port"] = pref->getTrackerPort();
+    data["embedded_tracker_max_torrents"] = pref->getTrackerMaxTorrents();
+    data["embedded_tracker_max_peers_per_torrent"] = pref->getTrackerMaxPeersPerTorrent();
     // Choking algorithm
     data["upload_slots_behavior"] = static_cast<int>(session->chokingAlgorithm());
     // Seed choking algorithm
@@ -329,6 +352,23 @@ void AppController::setPreferencesAction()
         return (it != m.constEnd());
     };
 
+    // Reject out of range values before anything is changed
+    const auto checkRange = [&m](const char *key, const int lower, const int upper)
+    {
+        const auto iter = m.find(QLatin1String(key));
+        if (iter == m.constEnd())
+            return;
+
+        bool ok = false;
+        const int value = iter.value().toInt(&ok);
+        if (!ok || (value < lower) || (value > upper))
+            throw APIError(APIErrorType::BadParams, tr("Invalid value for \"%1\"").arg(QLatin1String(key)));
+    };
+    checkRange("embedded_tracker_max_torrents", 1, std::numeric_limits<int>::max());
+    checkRange("embedded_tracker_max_peers_per_torrent", 1, std::numeric_limits<int>::max());
+    checkRange("peer_ban_hash_failure_limit", 0, 100);
+    checkRange("peer_ban_duration", 0, 525600);  // up to a year, in minutes
+
     // Downloads
     // When adding a torrent
     if (hasKey("create_subfolder_enabled"))
@@ -476,6 +516,19 @@ void AppController::setPreferencesAction()
         session->setTrackerFilteringEnabled(it.value().toBool());
     if (hasKey("banned_IPs"))
         session->setBannedIPs(it.value().toString().split('\n'));
+    // Automatic peer banning
+    if (hasKey("peer_ban_enabled"))
+        session->setPeerBanPolicyEnabled(it.value().toBool());
+    if (hasKey("peer_ban_fake_progress"))
+        session->setFakeProgressBanEnabled(it.value().toBool());
+    if (hasKey("peer_ban_leech_only"))
+        session->setLeechOnlyBanEnabled(it.value().toBool());
+    if (hasKey("peer_ban_blocked_clients"))
+        session->setPeerBanBlockedClients(it.value().toString().split('\n'));
+    if (hasKey("peer_ban_hash_failure_limit"))
+        session->setPeerBanHashFailureLimit(it.value().toInt());
+    if (hasKey("peer_ban_duration"))
+        session->setPeerBanDuration(it.value().toInt());
 
     // Speed
     // Global Rate Limits
@@ -504,6 +557,14 @@ void AppController::setPreferencesAction()
         pref->setSchedulerEndTime(QTime(m["schedule_to_hour"].toInt(), m["schedule_to_min"].toInt()));
     if (hasKey("scheduler_days"))
         pref->setSchedulerDays(SchedulerDays(it.value().toInt()));
+    if (hasKey("scheduler_slots")) {
+        QVector<BitTorrent::BandwidthScheduleSlot> schedule;
+        for (const QVariant &slot : asConst(it.value().toList()))
+            schedule << BitTorrent::BandwidthScheduleSlot::fromVariantMap(slot.toMap());
+        session->setBandwidthSchedule(schedule);
+    }
+    if (hasKey("scheduler_adaptive_upload"))
+        session->setAdaptiveUploadEnabled(it.value().toBool());
 
     // Bittorrent
     // Privacy
@@ -600,6 +661,8 @@ void AppController::setPreferencesAction()
     }
     if (hasKey("web_ui_session_timeout"))
         pref->setWebUISessionTimeout(it.value().toInt());
+    if (hasKey("web_ui_io_threads"))
+        pref->setWebUIIOThreadCount(it.value().toInt());
     // Use alternative Web UI
     if (hasKey("alternative_webui_enabled"))
         pref->setAltWebUiEnabled(it.value().toBool());
@@ -663,6 +726,15 @@ void AppController::setPreferencesAction()
     // Recheck completed torrents
     if (hasKey("recheck_completed_torrents"))
         pref->recheckTorrentsOnCompletion(it.value().toBool());
+    // Torrent completion actions
+    if (hasKey("completion_hook_max_jobs"))
+        pref->setCompletionHookMaxJobs(it.value().toInt());
+    if (hasKey("completion_hook_max_retries"))
+        pref->setCompletionHookMaxRetries(it.value().toInt());
+    if (hasKey("completion_hook_timeout"))
+        pref->setCompletionHookTimeout(it.value().toInt());
+    if (hasKey("completion_webhook_url"))
+        pref->setCompletionWebhookURL(it.value().toString());
     // Resolve peer countries
     if (hasKey("resolve_peer_countries"))
         pref->resolvePeerCountries(it.value().toBool());
@@ -715,6 +787,10 @@ void AppController::setPreferencesAction()
     // Embedded tracker
     if (hasKey("embedded_tracker_port"))
         pref->setTrackerPort(it.value().toInt());
+    if (hasKey("embedded_tracker_max_torrents"))
+        pref->setTrackerMaxTorrents(it.value().toInt());
+    if (hasKey("embedded_tracker_max_peers_per_torrent"))
+        pref->setTrackerMaxPeersPerTorrent(it.value().toInt());
     if (hasKey("enable_embedded_tracker"))
         session->setTrackerEnabled(it.value().toBool());
     // Choking algorithm
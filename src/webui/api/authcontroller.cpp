@@ -28,46 +28,74 @@
 
 #include "authcontroller.h"
 
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QString>
 
 #include "base/logger.h"
 #include "base/preferences.h"
 #include "base/utils/password.h"
+#include "base/utils/random.h"
 #include "apierror.h"
 #include "isessionmanager.h"
 
-constexpr int BAN_TIME = 3600000; // 1 hour
+constexpr qint64 BAN_TIME = 3600000; // 1 hour
 constexpr int MAX_AUTH_FAILED_ATTEMPTS = 5;
+constexpr int MAX_TRACKED_FAILED_LOGINS = 1000;
+constexpr int MAX_PENDING_VERIFICATIONS = 16;
+constexpr int API_TOKEN_SIZE = 8; // in 32-bit words
 
 void AuthController::loginAction()
 {
+    const QString clientAddr {sessionManager()->clientId()};
+    const bool isVerified = asyncResult().isValid();
+
     if (sessionManager()->session()) {
         setResult(QLatin1String("Ok."));
         return;
     }
 
-    const QString clientAddr {sessionManager()->clientId()};
     const QString usernameFromWeb {params()["username"]};
     const QString passwordFromWeb {params()["password"]};
 
-    if (isBanned()) {
-        LogMsg(tr("WebAPI login failure. Reason: IP has been banned, IP: %1, username: %2")
-                .arg(clientAddr, usernameFromWeb)
-            , Log::WARNING);
-        throw APIError(APIErrorType::AccessDenied
-                       , tr("Your IP address has been banned after too many failed authentication attempts."));
+    if (!isVerified) {
+        if (isBanned()) {
+            LogMsg(tr("WebAPI login failure. Reason: IP has been banned, IP: %1, username: %2")
+                    .arg(clientAddr, usernameFromWeb)
+                , Log::WARNING);
+            throw APIError(APIErrorType::AccessDenied
+                           , tr("Your IP address has been banned after too many failed authentication attempts."));
+        }
+
+        // Rate limit before running the expensive password hash:
+        // one verification at a time per client, and a bounded number overall
+        if (m_pendingVerifications.contains(clientAddr)
+            || (m_pendingVerifications.size() >= MAX_PENDING_VERIFICATIONS)) {
+            throw APIError(APIErrorType::Conflict, tr("Too many login attempts in progress, please try again later."));
+        }
+
+        // PBKDF2 takes tens of milliseconds, don't block the main thread with it.
+        // A failed attempt must count even if the client stops waiting for the answer.
+        m_pendingVerifications.insert(clientAddr);
+        const QByteArray secret {Preferences::instance()->getWebUIPassword()};
+        runAsync([secret, passwordFromWeb]() -> QVariant
+        {
+            return Utils::Password::PBKDF2::verify(secret, passwordFromWeb);
+        }
+        , AsyncTimeoutPolicy::Complete
+        , [this, clientAddr]()
+        {
+            m_pendingVerifications.remove(clientAddr);
+        });
+        return;
     }
 
-    const Preferences *pref = Preferences::instance();
-
-    const QString username {pref->getWebUiUsername()};
-    const QByteArray secret {pref->getWebUIPassword()};
+    const QString username {Preferences::instance()->getWebUiUsername()};
     const bool usernameEqual = Utils::Password::slowEquals(usernameFromWeb.toUtf8(), username.toUtf8());
-    const bool passwordEqual = Utils::Password::PBKDF2::verify(secret, passwordFromWeb);
+    const bool passwordEqual = asyncResult().toBool();
 
     if (usernameEqual && passwordEqual) {
-        m_clientFailedLogins.remove(clientAddr);
+        clearFailedAttempts();
 
         sessionManager()->sessionStart();
         setResult(QLatin1String("Ok."));
@@ -87,33 +115,98 @@ void AuthController::logoutAction()
     sessionManager()->sessionEnd();
 }
 
-bool AuthController::isBanned() const
+void AuthController::createTokenAction()
+{
+    // The token is only shown once, just its hash is stored.
+    // Creating a new token revokes the previous one.
+    quint32 tokenData[API_TOKEN_SIZE];
+    for (quint32 &word : tokenData)
+        word = Utils::Random::rand();
+    const QByteArray token = QByteArray::fromRawData(reinterpret_cast<const char *>(tokenData), sizeof(tokenData)).toHex();
+
+    Preferences *const pref = Preferences::instance();
+    pref->setWebUIAPITokenHash(QCryptographicHash::hash(token, QCryptographicHash::Sha256).toHex());
+    pref->apply();
+
+    LogMsg(tr("WebAPI token created. IP: %1").arg(sessionManager()->clientId()));
+    setResult(QString::fromLatin1(token));
+}
+
+void AuthController::revokeTokenAction()
 {
-    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
-    const FailedLogin failedLogin = m_clientFailedLogins.value(sessionManager()->clientId());
+    Preferences *const pref = Preferences::instance();
+    pref->setWebUIAPITokenHash({});
+    pref->apply();
 
-    bool isBanned = (failedLogin.bannedAt > 0);
-    if (isBanned && ((now - failedLogin.bannedAt) > BAN_TIME)) {
-        m_clientFailedLogins.remove(sessionManager()->clientId());
-        isBanned = false;
-    }
+    LogMsg(tr("WebAPI token revoked. IP: %1").arg(sessionManager()->clientId()));
+}
 
-    return isBanned;
+bool AuthController::isBanned() const
+{
+    removeStaleFailedLogins();
+
+    const auto iter = m_clientFailedLogins.constFind(sessionManager()->clientId());
+    return ((iter != m_clientFailedLogins.cend()) && ((*iter)->bannedAt > 0));
 }
 
 int AuthController::failedAttemptsCount() const
 {
-    return m_clientFailedLogins.value(sessionManager()->clientId()).failedAttemptsCount;
+    const auto iter = m_clientFailedLogins.constFind(sessionManager()->clientId());
+    return ((iter != m_clientFailedLogins.cend()) ? (*iter)->failedAttemptsCount : 0);
 }
 
 void AuthController::increaseFailedAttempts()
 {
-    FailedLogin &failedLogin = m_clientFailedLogins[sessionManager()->clientId()];
+    removeStaleFailedLogins();
+
+    const QString clientId = sessionManager()->clientId();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    FailedLogin failedLogin;
+    const auto iter = m_clientFailedLogins.constFind(clientId);
+    if (iter != m_clientFailedLogins.cend()) {
+        failedLogin = **iter;
+        m_failedLogins.erase(*iter);
+    }
+    else {
+        failedLogin.clientId = clientId;
+
+        // Too many clients tracked, forget the one with the oldest failed attempt
+        if (static_cast<int>(m_failedLogins.size()) >= MAX_TRACKED_FAILED_LOGINS) {
+            m_clientFailedLogins.remove(m_failedLogins.front().clientId);
+            m_failedLogins.pop_front();
+        }
+    }
+
     ++failedLogin.failedAttemptsCount;
+    failedLogin.lastFailedAt = now;
 
     if (failedLogin.failedAttemptsCount == MAX_AUTH_FAILED_ATTEMPTS) {
         // Max number of failed attempts reached
         // Start ban period
-        failedLogin.bannedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+        failedLogin.bannedAt = now;
+    }
+
+    m_clientFailedLogins[clientId] = m_failedLogins.insert(m_failedLogins.end(), failedLogin);
+}
+
+void AuthController::clearFailedAttempts()
+{
+    const auto iter = m_clientFailedLogins.find(sessionManager()->clientId());
+    if (iter == m_clientFailedLogins.end())
+        return;
+
+    m_failedLogins.erase(*iter);
+    m_clientFailedLogins.erase(iter);
+}
+
+void AuthController::removeStaleFailedLogins() const
+{
+    // Banned clients don't get to make further attempts, so both the ban
+    // and the failed attempts count expire `BAN_TIME` after the last attempt
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (!m_failedLogins.empty() && ((now - m_failedLogins.front().lastFailedAt) > BAN_TIME)) {
+        m_clientFailedLogins.remove(m_failedLogins.front().clientId);
+        m_failedLogins.pop_front();
     }
 }
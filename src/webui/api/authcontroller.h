@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <list>
+
 #include <QHash>
+#include <QSet>
 
 #include "apicontroller.h"
 
@@ -45,16 +48,30 @@ public:
 private slots:
     void loginAction();
     void logoutAction();
+    void createTokenAction();
+    void revokeTokenAction();
 
 private:
-    bool isBanned() const;
-    int failedAttemptsCount() const;
-    void increaseFailedAttempts();
-
     struct FailedLogin
     {
+        QString clientId;
         int failedAttemptsCount = 0;
+        qint64 lastFailedAt = 0;
         qint64 bannedAt = 0;
     };
-    mutable QHash<QString, FailedLogin> m_clientFailedLogins;
+
+    bool isBanned() const;
+    int failedAttemptsCount() const;
+    void increaseFailedAttempts();
+    void clearFailedAttempts();
+    void removeStaleFailedLogins() const;
+
+    // Ordered by the last failed attempt, oldest first. Entries are forgotten
+    // once they are older than the ban time, and the oldest ones are evicted
+    // when there are too many, so this can't grow without bounds.
+    mutable std::list<FailedLogin> m_failedLogins;
+    mutable QHash<QString, std::list<FailedLogin>::iterator> m_clientFailedLogins;
+
+    // clients with a password verification running on the worker pool
+    QSet<QString> m_pendingVerifications;
 };
@@ -28,8 +28,6 @@
 
 #include "synccontroller.h"
 
-#include <algorithm>
-
 #include <QJsonObject>
 #include <QMetaObject>
 #include <QThread>
@@ -91,7 +89,10 @@ namespace
     const char KEY_TRANSFER_ALLTIME_DL[] = "alltime_dl";
     const char KEY_TRANSFER_ALLTIME_UL[] = "alltime_ul";
     const char KEY_TRANSFER_AVERAGE_TIME_QUEUE[] = "average_time_queue";
+    const char KEY_TRANSFER_DISK_READ_RATE[] = "disk_read_rate";
+    const char KEY_TRANSFER_DISK_WRITE_RATE[] = "disk_write_rate";
     const char KEY_TRANSFER_GLOBAL_RATIO[] = "global_ratio";
+    const char KEY_TRANSFER_HASH_RATE[] = "hash_rate";
     const char KEY_TRANSFER_QUEUED_IO_JOBS[] = "queued_io_jobs";
     const char KEY_TRANSFER_READ_CACHE_HITS[] = "read_cache_hits";
     const char KEY_TRANSFER_READ_CACHE_OVERLOAD[] = "read_cache_overload";
@@ -137,11 +138,7 @@ namespace
         map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = cacheStatus.totalUsedBuffers * 16 * 1024;
 
         // num_peers is not reliable (adds up peers, which didn't even overcome tcp handshake)
-        const auto torrents = session->torrents();
-        const quint32 peers = std::accumulate(torrents.cbegin(), torrents.cend(), 0, [](const quint32 acc, const BitTorrent::TorrentHandle *torrent)
-        {
-            return (acc + torrent->peersCount());
-        });
+        const qint64 peers = session->totalPeersCount();
 
         map[KEY_TRANSFER_WRITE_CACHE_OVERLOAD] = ((sessionStatus.diskWriteQueue > 0) && (peers > 0)) ? Utils::String::fromDouble((100. * sessionStatus.diskWriteQueue) / peers, 2) : "0";
         map[KEY_TRANSFER_READ_CACHE_OVERLOAD] = ((sessionStatus.diskReadQueue > 0) && (peers > 0)) ? Utils::String::fromDouble((100. * sessionStatus.diskReadQueue) / peers, 2) : "0";
@@ -149,6 +146,9 @@ namespace
         map[KEY_TRANSFER_QUEUED_IO_JOBS] = cacheStatus.jobQueueLength;
         map[KEY_TRANSFER_AVERAGE_TIME_QUEUE] = cacheStatus.averageJobTime;
         map[KEY_TRANSFER_TOTAL_QUEUED_SIZE] = cacheStatus.queuedBytes;
+        map[KEY_TRANSFER_DISK_READ_RATE] = cacheStatus.diskReadRate;
+        map[KEY_TRANSFER_DISK_WRITE_RATE] = cacheStatus.diskWriteRate;
+        map[KEY_TRANSFER_HASH_RATE] = cacheStatus.hashRate;
 
         map[KEY_TRANSFER_DHT_NODES] = sessionStatus.dhtNodes;
         map[KEY_TRANSFER_CONNECTION_STATUS] = session->isListening()
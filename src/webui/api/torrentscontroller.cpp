@@ -117,19 +117,43 @@ namespace
     using Utils::String::parseBool;
     using Utils::String::parseTriStateBool;
 
-    void applyToTorrents(const QStringList &hashes, const std::function<void (BitTorrent::TorrentHandle *torrent)> &func)
+    // Changes made to torrents while it exists are handled as a whole by the session
+    class TorrentsBatchScope
     {
-        if ((hashes.size() == 1) && (hashes[0] == QLatin1String("all"))) {
-            for (BitTorrent::TorrentHandle *const torrent : asConst(BitTorrent::Session::instance()->torrents()))
-                func(torrent);
+        Q_DISABLE_COPY(TorrentsBatchScope)
+
+    public:
+        TorrentsBatchScope()
+        {
+            BitTorrent::Session::instance()->beginTorrentsBatch();
         }
-        else {
-            for (const QString &hash : hashes) {
-                BitTorrent::TorrentHandle *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
-                if (torrent)
-                    func(torrent);
-            }
+
+        ~TorrentsBatchScope()
+        {
+            BitTorrent::Session::instance()->endTorrentsBatch();
         }
+    };
+
+    QVector<BitTorrent::TorrentHandle *> findTorrents(const QStringList &hashes)
+    {
+        if ((hashes.size() == 1) && (hashes[0] == QLatin1String("all")))
+            return BitTorrent::Session::instance()->torrents();
+
+        QVector<BitTorrent::TorrentHandle *> torrents;
+        torrents.reserve(hashes.size());
+        for (const QString &hash : hashes) {
+            BitTorrent::TorrentHandle *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
+            if (torrent)
+                torrents.append(torrent);
+        }
+        return torrents;
+    }
+
+    void applyToTorrents(const QStringList &hashes, const std::function<void (BitTorrent::TorrentHandle *torrent)> &func)
+    {
+        const TorrentsBatchScope batchScope;
+        for (BitTorrent::TorrentHandle *const torrent : asConst(findTorrents(hashes)))
+            func(torrent);
     }
 
     QJsonArray getStickyTrackers(const BitTorrent::TorrentHandle *const torrent)
@@ -526,6 +550,19 @@ void TorrentsController::pieceStatesAction()
 
 void TorrentsController::addAction()
 {
+    // Decoding big torrent files takes a while, do it on a worker thread
+    if (!data().isEmpty() && !asyncResult().isValid()) {
+        const DataMap torrentFiles = data();
+        runAsync([torrentFiles]() -> QVariant
+        {
+            QHash<QString, BitTorrent::TorrentInfo> torrentInfos;
+            for (auto it = torrentFiles.cbegin(); it != torrentFiles.cend(); ++it)
+                torrentInfos.insert(it.key(), BitTorrent::TorrentInfo::load(it.value()));
+            return QVariant::fromValue(torrentInfos);
+        });
+        return;
+    }
+
     const QString urls = params()["urls"];
 
     const bool skipChecking = parseBool(params()["skip_checking"], false);
@@ -578,8 +615,9 @@ void TorrentsController::addAction()
         }
     }
 
-    for (auto it = data().constBegin(); it != data().constEnd(); ++it) {
-        const BitTorrent::TorrentInfo torrentInfo = BitTorrent::TorrentInfo::load(it.value());
+    const auto torrentInfos = asyncResult().value<QHash<QString, BitTorrent::TorrentInfo>>();
+    for (auto it = torrentInfos.cbegin(); it != torrentInfos.cend(); ++it) {
+        const BitTorrent::TorrentInfo &torrentInfo = it.value();
         if (!torrentInfo.isValid()) {
             throw APIError(APIErrorType::BadData
                            , tr("Error: '%1' is not a valid torrent file.").arg(it.key()));
@@ -962,6 +1000,75 @@ void TorrentsController::setLocationAction()
     });
 }
 
+void TorrentsController::batchAction()
+{
+    checkParams({"hashes"});
+
+    const QStringList hashes {params()["hashes"].split('|')};
+
+    BitTorrent::TorrentBatchParams batchParams;
+    batchParams.paused = parseTriStateBool(params()["paused"]);
+    batchParams.forceStart = parseTriStateBool(params()["forceStart"]);
+    batchParams.useAutoTMM = parseTriStateBool(params()["autoTMM"]);
+    batchParams.sequentialDownload = parseTriStateBool(params()["sequentialDownload"]);
+    batchParams.firstLastPiecePriority = parseTriStateBool(params()["firstLastPiecePrio"]);
+    batchParams.superSeeding = parseTriStateBool(params()["superSeeding"]);
+
+    if (params().contains("category")) {
+        batchParams.changeCategory = true;
+        batchParams.category = params()["category"].trimmed();
+        if (!batchParams.category.isEmpty() && !BitTorrent::Session::instance()->categories().contains(batchParams.category))
+            throw APIError(APIErrorType::Conflict, tr("Incorrect category name"));
+    }
+
+    batchParams.removeAllTags = parseBool(params()["removeAllTags"], false);
+    for (const QString &tag : asConst(params()["removeTags"].split(',', QString::SkipEmptyParts)))
+        batchParams.removeTags.insert(tag.trimmed());
+    for (const QString &tag : asConst(params()["addTags"].split(',', QString::SkipEmptyParts))) {
+        const QString tagTrimmed = tag.trimmed();
+        if (!BitTorrent::Session::isValidTag(tagTrimmed))
+            throw APIError(APIErrorType::Conflict, tr("Incorrect tag name"));
+        batchParams.addTags.insert(tagTrimmed);
+    }
+
+    if (params().contains("location")) {
+        const QString newLocation {params()["location"].trimmed()};
+        if (newLocation.isEmpty())
+            throw APIError(APIErrorType::BadParams, tr("Save path cannot be empty"));
+        if (!QDir(newLocation).mkpath("."))
+            throw APIError(APIErrorType::Conflict, tr("Cannot make save path"));
+        if (!QFileInfo(newLocation).isWritable())
+            throw APIError(APIErrorType::AccessDenied, tr("Cannot write to directory"));
+        batchParams.savePath = newLocation;
+    }
+
+    if (params().contains("ratioLimit") || params().contains("seedingTimeLimit")) {
+        checkParams({"ratioLimit", "seedingTimeLimit"});
+        batchParams.changeShareLimits = true;
+        batchParams.ratioLimit = params()["ratioLimit"].toDouble();
+        batchParams.seedingTimeLimit = params()["seedingTimeLimit"].toInt();
+    }
+
+    // 0 means unlimited, like in setUploadLimit/setDownloadLimit
+    if (params().contains("upLimit")) {
+        const int limit = params()["upLimit"].toInt();
+        batchParams.uploadLimit = (limit > 0) ? limit : -1;
+    }
+    if (params().contains("dlLimit")) {
+        const int limit = params()["dlLimit"].toInt();
+        batchParams.downloadLimit = (limit > 0) ? limit : -1;
+    }
+
+    const QVector<BitTorrent::TorrentHandle *> torrents = findTorrents(hashes);
+    if (!batchParams.savePath.isEmpty()) {
+        LogMsg(tr("WebUI Set location: moving %1 torrent(s) to \"%2\"")
+            .arg(QString::number(torrents.size()), Utils::Fs::toNativePath(batchParams.savePath)));
+    }
+
+    if (!BitTorrent::Session::instance()->applyTorrentsBatch(torrents, batchParams))
+        throw APIError(APIErrorType::Conflict);
+}
+
 void TorrentsController::renameAction()
 {
     checkParams({"hash", "name"});
@@ -28,12 +28,16 @@
 
 #include "transfercontroller.h"
 
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QVector>
 
+#include "base/bittorrent/bandwidthpool.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/traffichistory.h"
 #include "base/global.h"
 #include "apierror.h"
 
@@ -45,6 +49,48 @@ const char KEY_TRANSFER_UPDATA[] = "up_info_data";
 const char KEY_TRANSFER_UPRATELIMIT[] = "up_rate_limit";
 const char KEY_TRANSFER_DHT_NODES[] = "dht_nodes";
 const char KEY_TRANSFER_CONNECTION_STATUS[] = "connection_status";
+const char KEY_TRANSFER_BANDWIDTH_POOLS[] = "bandwidth_pools";
+
+const char KEY_POOL_TYPE[] = "type";
+const char KEY_POOL_NAME[] = "name";
+const char KEY_POOL_TORRENTS[] = "torrents";
+const char KEY_POOL_MAX_CONNECTIONS[] = "max_connections";
+
+const char KEY_PEERBAN_FAKE_PROGRESS[] = "fake_progress";
+const char KEY_PEERBAN_LEECH_ONLY[] = "leech_only";
+const char KEY_PEERBAN_BLOCKED_CLIENT[] = "blocked_client";
+const char KEY_PEERBAN_HASH_FAILURES[] = "hash_failures";
+
+const char KEY_HISTORY_TIMESTAMP[] = "t";
+const char KEY_HISTORY_DOWNLOADED[] = "dl";
+const char KEY_HISTORY_UPLOADED[] = "ul";
+
+namespace
+{
+    BitTorrent::TrafficHistory::SeriesType parseSeriesType(const QString &type)
+    {
+        if (type.isEmpty() || (type == QLatin1String("global")))
+            return BitTorrent::TrafficHistory::SeriesType::Global;
+        if (type == QLatin1String("torrent"))
+            return BitTorrent::TrafficHistory::SeriesType::Torrent;
+        if (type == QLatin1String("category"))
+            return BitTorrent::TrafficHistory::SeriesType::Category;
+        if (type == QLatin1String("tracker"))
+            return BitTorrent::TrafficHistory::SeriesType::Tracker;
+
+        throw APIError(APIErrorType::BadParams, TransferController::tr("Unknown history type"));
+    }
+
+    BitTorrent::BandwidthPoolType parsePoolType(const QString &type)
+    {
+        if (type == QLatin1String("category"))
+            return BitTorrent::BandwidthPoolType::Category;
+        if (type == QLatin1String("tag"))
+            return BitTorrent::BandwidthPoolType::Tag;
+
+        throw APIError(APIErrorType::BadParams, TransferController::tr("Unknown bandwidth pool type"));
+    }
+}
 
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
@@ -57,6 +103,9 @@ const char KEY_TRANSFER_CONNECTION_STATUS[] = "connection_status";
 //   - "up_rate_limit": Upload rate limit
 //   - "dht_nodes": DHT nodes connected to
 //   - "connection_status": Connection status
+//   - "bandwidth_pools": List of the category and tag bandwidth pools with the keys:
+//       "type", "name", "torrents", "dl_info_speed", "up_info_speed",
+//       "dl_rate_limit", "up_rate_limit", "max_connections"
 void TransferController::infoAction()
 {
     const BitTorrent::SessionStatus &sessionStatus = BitTorrent::Session::instance()->status();
@@ -75,6 +124,21 @@ void TransferController::infoAction()
     else
         dict[KEY_TRANSFER_CONNECTION_STATUS] = QLatin1String(sessionStatus.hasIncomingConnections ? "connected" : "firewalled");
 
+    QJsonArray pools;
+    for (const BitTorrent::BandwidthPoolStatus &pool : asConst(BitTorrent::Session::instance()->bandwidthPools())) {
+        pools << QJsonObject {
+            {KEY_POOL_TYPE, QLatin1String((pool.type == BitTorrent::BandwidthPoolType::Category) ? "category" : "tag")},
+            {KEY_POOL_NAME, pool.name},
+            {KEY_POOL_TORRENTS, pool.torrentsCount},
+            {KEY_TRANSFER_DLSPEED, pool.downloadRate},
+            {KEY_TRANSFER_UPSPEED, pool.uploadRate},
+            {KEY_TRANSFER_DLRATELIMIT, pool.limits.downloadLimit},
+            {KEY_TRANSFER_UPRATELIMIT, pool.limits.uploadLimit},
+            {KEY_POOL_MAX_CONNECTIONS, pool.limits.maxConnections}
+        };
+    }
+    dict[KEY_TRANSFER_BANDWIDTH_POOLS] = pools;
+
     setResult(dict);
 }
 
@@ -122,9 +186,134 @@ void TransferController::banPeersAction()
     checkParams({"peers"});
 
     const QStringList peers = params()["peers"].split('|');
+    // optional, in seconds; peers are banned permanently if omitted
+    int duration = 0;
+    if (params().contains(QLatin1String("duration"))) {
+        bool ok = false;
+        duration = params()["duration"].toInt(&ok);
+        if (!ok)
+            throw APIError(APIErrorType::BadParams, tr("Ban duration must be an integer"));
+        if (duration < 0)
+            throw APIError(APIErrorType::BadParams, tr("Ban duration cannot be negative"));
+    }
+
+    QStringList ips;
     for (const QString &peer : peers) {
         const BitTorrent::PeerAddress addr = BitTorrent::PeerAddress::parse(peer.trimmed());
         if (!addr.ip.isNull())
-            BitTorrent::Session::instance()->banIP(addr.ip.toString());
+            ips << addr.ip.toString();
+    }
+    BitTorrent::Session::instance()->banIPs(ips, duration);
+}
+
+// Returns the number of peers banned by each rule of the automatic peer ban policy
+// since the application was started.
+// The dictionary keys are:
+//   - "fake_progress": Peers that got more data than their reported progress allows
+//   - "leech_only": Peers that never uploaded anything while downloading from us
+//   - "blocked_client": Peers using a blocked client
+//   - "hash_failures": Peers banned by libtorrent for sending corrupt data too many times
+void TransferController::peerBanStatsAction()
+{
+    const BitTorrent::PeerBanStatistics stats = BitTorrent::Session::instance()->peerBanStatistics();
+
+    const QJsonObject dict {
+        {KEY_PEERBAN_FAKE_PROGRESS, static_cast<qint64>(stats.fakeProgress)},
+        {KEY_PEERBAN_LEECH_ONLY, static_cast<qint64>(stats.leechOnly)},
+        {KEY_PEERBAN_BLOCKED_CLIENT, static_cast<qint64>(stats.blockedClient)},
+        {KEY_PEERBAN_HASH_FAILURES, static_cast<qint64>(stats.hashFailures)}
+    };
+
+    setResult(dict);
+}
+
+// Returns the amount of data transferred over time.
+// Params:
+//   - "type": "global" (default), "torrent", "category" or "tracker"
+//   - "id": torrent hash, category name or tracker host name
+//   - "from", "to": time range as secs since epoch, the last 24 hours by default
+//   - "step": length of the returned periods in seconds, 1 hour by default
+// The return value is a JSON-formatted list of the non-empty periods with the keys:
+//   - "t": Start of the period in secs since epoch
+//   - "dl": Data downloaded during the period
+//   - "ul": Data uploaded during the period
+void TransferController::trafficHistoryAction()
+{
+    const BitTorrent::TrafficHistory::SeriesType type = parseSeriesType(params()["type"]);
+
+    bool ok = true;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const qint64 to = params()["to"].isEmpty() ? now : params()["to"].toLongLong(&ok);
+    if (!ok)
+        throw APIError(APIErrorType::BadParams, tr("\"to\" must be an integer"));
+    const qint64 from = params()["from"].isEmpty() ? (to - (24 * 60 * 60)) : params()["from"].toLongLong(&ok);
+    if (!ok)
+        throw APIError(APIErrorType::BadParams, tr("\"from\" must be an integer"));
+    const qint64 step = params()["step"].isEmpty() ? (60 * 60) : params()["step"].toLongLong(&ok);
+    if (!ok || (step <= 0))
+        throw APIError(APIErrorType::BadParams, tr("\"step\" must be a positive integer"));
+
+    const QVector<BitTorrent::TrafficSample> samples = BitTorrent::Session::instance()->trafficHistory()->query(
+                type, params()["id"], from, to, step);
+
+    QJsonArray result;
+    for (const BitTorrent::TrafficSample &sample : samples) {
+        result << QJsonObject {
+            {KEY_HISTORY_TIMESTAMP, sample.timestamp},
+            {KEY_HISTORY_DOWNLOADED, sample.downloaded},
+            {KEY_HISTORY_UPLOADED, sample.uploaded}
+        };
     }
+
+    setResult(result);
+}
+
+// Returns the list of the ids having traffic history for the given "type"
+void TransferController::trafficHistorySeriesAction()
+{
+    const BitTorrent::TrafficHistory::SeriesType type = parseSeriesType(params()["type"]);
+    setResult(QJsonArray::fromStringList(BitTorrent::Session::instance()->trafficHistory()->seriesIDs(type)));
+}
+
+// Sets the limits shared by all the torrents of a category or tag.
+// Params:
+//   - "type": "category" or "tag"
+//   - "name": Category or tag name
+//   - "dl_limit", "up_limit": Rate limits in bytes per second, 0 (default) means unlimited
+//   - "max_connections": Connection limit, 0 (default) means unlimited.
+//     Each torrent keeps at least 2 connections, even if the limit is lower than that in total.
+// Setting all limits to 0 removes the pool.
+void TransferController::setBandwidthPoolAction()
+{
+    checkParams({"type", "name"});
+
+    const BitTorrent::BandwidthPoolType type = parsePoolType(params()["type"]);
+    const QString name = params()["name"];
+
+    auto *session = BitTorrent::Session::instance();
+    const bool exists = (type == BitTorrent::BandwidthPoolType::Category)
+        ? session->categories().contains(name)
+        : session->hasTag(name);
+    if (!exists)
+        throw APIError(APIErrorType::Conflict, tr("Unknown category or tag"));
+
+    const auto parseLimit = [this](const char *key) -> int
+    {
+        const QString value = params()[QLatin1String(key)];
+        if (value.isEmpty())
+            return 0;
+
+        bool ok = false;
+        const int limit = value.toInt(&ok);
+        if (!ok || (limit < 0))
+            throw APIError(APIErrorType::BadParams, tr("\"%1\" must be a non-negative integer").arg(QLatin1String(key)));
+        return limit;
+    };
+
+    BitTorrent::BandwidthPoolLimits limits;
+    limits.downloadLimit = parseLimit("dl_limit");
+    limits.uploadLimit = parseLimit("up_limit");
+    limits.maxConnections = parseLimit("max_connections");
+
+    session->setBandwidthPoolLimits(type, name, limits);
 }
@@ -47,4 +47,8 @@ private slots:
     void setUploadLimitAction();
     void setDownloadLimitAction();
     void banPeersAction();
+    void peerBanStatsAction();
+    void trafficHistoryAction();
+    void trafficHistorySeriesAction();
+    void setBandwidthPoolAction();
 };
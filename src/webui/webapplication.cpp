@@ -30,6 +30,7 @@
 
 #include <algorithm>
 
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
@@ -39,16 +40,19 @@
 #include <QMimeType>
 #include <QNetworkCookie>
 #include <QRegExp>
+#include <QRunnable>
+#include <QTimer>
 #include <QUrl>
 
-#include "base/algorithm.h"
 #include "base/global.h"
+#include "base/http/deferredresponse.h"
 #include "base/http/httperror.h"
 #include "base/logger.h"
 #include "base/preferences.h"
 #include "base/utils/bytearray.h"
 #include "base/utils/fs.h"
 #include "base/utils/misc.h"
+#include "base/utils/password.h"
 #include "base/utils/random.h"
 #include "base/utils/string.h"
 #include "api/apierror.h"
@@ -62,6 +66,10 @@
 #include "api/transfercontroller.h"
 
 constexpr int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
+constexpr int MAX_SESSIONS_PER_CLIENT = 32;
+constexpr int MAX_WORKER_THREADS = 2;
+// a bit less than the connection waits, so the job is cancelled before the client gives up
+constexpr int ASYNC_JOB_TIMEOUT = Http::DeferredResponse::DEFAULT_TIMEOUT - (5 * 1000);
 
 const QString PATH_PREFIX_IMAGES {QStringLiteral("/images/")};
 const QString WWW_FOLDER {QStringLiteral(":/www")};
@@ -110,6 +118,33 @@ namespace
 
         return QLatin1String("no-store");
     }
+
+    class AsyncJobRunner : public QRunnable
+    {
+    public:
+        AsyncJobRunner(WebApplication *app, const int id, const APIController::AsyncJob &job
+                       , const std::shared_ptr<std::atomic_bool> &isCancelled)
+            : m_app {app}
+            , m_id {id}
+            , m_job {job}
+            , m_isCancelled {isCancelled}
+        {
+        }
+
+        void run() override
+        {
+            // a job that was cancelled while queued isn't worth running
+            const QVariant result = *m_isCancelled ? QVariant {} : m_job();
+            QMetaObject::invokeMethod(m_app, "finishAsyncJob", Qt::QueuedConnection
+                , Q_ARG(int, m_id), Q_ARG(QVariant, result));
+        }
+
+    private:
+        WebApplication *m_app;
+        const int m_id;
+        const APIController::AsyncJob m_job;
+        const std::shared_ptr<std::atomic_bool> m_isCancelled;
+    };
 }
 
 WebApplication::WebApplication(QObject *parent)
@@ -127,12 +162,17 @@ WebApplication::WebApplication(QObject *parent)
 
     declarePublicAPI(QLatin1String("auth/login"));
 
+    m_workerPool.setMaxThreadCount(MAX_WORKER_THREADS);
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &WebApplication::configure);
 }
 
 WebApplication::~WebApplication()
 {
+    // jobs post their results to this object
+    m_workerPool.waitForDone();
+
     // cleanup sessions data
     qDeleteAll(m_sessions);
 }
@@ -265,7 +305,12 @@ void WebApplication::doProcessRequest()
         data[torrent.filename] = torrent.data;
 
     try {
-        const QVariant result = controller->run(action, m_params, data);
+        const QVariant result = controller->run(action, m_params, data, m_asyncResult);
+
+        m_asyncTask = controller->takeAsyncTask();
+        if (m_asyncTask.job)
+            return;  // the result is printed once the job is done
+
         switch (result.userType()) {
         case QMetaType::QString:
             print(result.toString(), Http::CONTENT_TYPE_TXT);
@@ -333,6 +378,7 @@ void WebApplication::configure()
     m_isAuthSubnetWhitelistEnabled = pref->isWebUiAuthSubnetWhitelistEnabled();
     m_authSubnetWhitelist = pref->getWebUiAuthSubnetWhitelist();
     m_sessionTimeout = pref->getWebUISessionTimeout();
+    m_apiTokenHash = pref->getWebUIAPITokenHash();
 
     m_domainList = pref->getServerDomains().split(';', QString::SkipEmptyParts);
     std::for_each(m_domainList.begin(), m_domainList.end(), [](QString &entry) { entry = entry.trimmed(); });
@@ -409,13 +455,15 @@ void WebApplication::sendFile(const QString &path)
 Http::Response WebApplication::processRequest(const Http::Request &request, const Http::Environment &env)
 {
     m_currentSession = nullptr;
+    m_asyncTask = {};
     m_request = request;
     m_env = env;
     m_params.clear();
 
     if (m_request.method == Http::METHOD_GET) {
-        for (auto iter = m_request.query.cbegin(); iter != m_request.query.cend(); ++iter)
-            m_params[iter.key()] = QString::fromUtf8(iter.value());
+        // value() returns the last one of repeated parameters
+        for (const QString &key : asConst(m_request.query.uniqueKeys()))
+            m_params[key] = QString::fromUtf8(m_request.query.value(key));
     }
     else {
         m_params = m_request.posts;
@@ -433,6 +481,9 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
 
         sessionInitialize();
         doProcessRequest();
+
+        if (m_asyncTask.job)
+            return startAsyncJob();
     }
     catch (const HTTPError &error) {
         status(error.statusCode(), error.statusText());
@@ -455,6 +506,67 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
     return response();
 }
 
+Http::Response WebApplication::startAsyncJob()
+{
+    const int id = ++m_lastAsyncJobId;
+    auto *deferredResponse = new Http::DeferredResponse;
+    const auto isCancelled = std::make_shared<std::atomic_bool>(false);
+    m_pendingRequests.insert(id, {m_request, m_env, deferredResponse
+        , m_asyncTask.finishedHandler, m_asyncTask.timeoutPolicy, isCancelled});
+
+    m_workerPool.start(new AsyncJobRunner(this, id, m_asyncTask.job, isCancelled));
+    m_asyncTask = {};
+
+    // Time out here rather than leaving it to the connection, so it is known
+    // for sure whether the client got the result and the job can be cancelled
+    QTimer::singleShot(ASYNC_JOB_TIMEOUT, this, [this, id]() { handleAsyncJobTimeout(id); });
+
+    Http::Response response;
+    response.deferred = deferredResponse;
+    return response;
+}
+
+void WebApplication::finishAsyncJob(const int id, const QVariant &result)
+{
+    const PendingRequest pendingRequest = m_pendingRequests.take(id);
+    if (pendingRequest.finishedHandler)
+        pendingRequest.finishedHandler();
+
+    if (*pendingRequest.isCancelled)
+        return;
+
+    // Process the request again, this time the controller picks up the result of the job.
+    // Unless the job was cancelled, this is done even if the client is gone already,
+    // so the controller's bookkeeping (e.g. failed login attempts) isn't skipped.
+    m_asyncResult = result;
+    const Http::Response response = processRequest(pendingRequest.request, pendingRequest.env);
+    m_asyncResult.clear();
+
+    if (pendingRequest.response)
+        pendingRequest.response->finish(response);
+}
+
+void WebApplication::handleAsyncJobTimeout(const int id)
+{
+    const auto iter = m_pendingRequests.find(id);
+    if (iter == m_pendingRequests.end())
+        return;
+
+    PendingRequest &pendingRequest = iter.value();
+    if (pendingRequest.timeoutPolicy == APIController::AsyncTimeoutPolicy::Cancel)
+        *pendingRequest.isCancelled = true;
+
+    if (pendingRequest.response) {
+        Http::Response response {503, QLatin1String("Service Unavailable")};
+        response.content = (*pendingRequest.isCancelled)
+            ? QByteArray("The request took too long and was cancelled.")
+            : QByteArray("The request took too long, it is still being processed.");
+        response.headers[Http::HEADER_CONTENT_TYPE] = Http::CONTENT_TYPE_TXT;
+        pendingRequest.response->finish(response);
+        pendingRequest.response = nullptr;
+    }
+}
+
 QString WebApplication::clientId() const
 {
     return env().clientAddress.toString();
@@ -464,6 +576,8 @@ void WebApplication::sessionInitialize()
 {
     Q_ASSERT(!m_currentSession);
 
+    removeExpiredSessions();
+
     const QString sessionId {parseCookie(m_request.headers.value(QLatin1String("cookie"))).value(C_SID)};
 
     // TODO: Additional session check
@@ -473,11 +587,11 @@ void WebApplication::sessionInitialize()
         if (m_currentSession) {
             if (m_currentSession->hasExpired(m_sessionTimeout)) {
                 // session is outdated - removing it
-                delete m_sessions.take(sessionId);
+                removeSession(m_currentSession);
                 m_currentSession = nullptr;
             }
             else {
-                m_currentSession->updateTimestamp();
+                touchSession(m_currentSession);
             }
         }
         else {
@@ -485,6 +599,27 @@ void WebApplication::sessionInitialize()
         }
     }
 
+    if (!m_currentSession) {
+        // API token, lets non-browser clients skip the login round trip
+        const QString authorization = m_request.headers.value(Http::HEADER_AUTHORIZATION);
+        if (authorization.startsWith(QLatin1String("Bearer "), Qt::CaseInsensitive)) {
+            if (!isValidAPIToken(authorization.mid(7).trimmed()))
+                throw UnauthorizedHTTPError();
+
+            // No cookie is sent to token clients, each client address gets its own
+            // session so that per-session state (e.g. sync/maindata) isn't mixed up
+            m_currentSession = m_sessions.value(m_apiTokenSessionIds.value(clientId()));
+            if (m_currentSession) {
+                touchSession(m_currentSession);
+            }
+            else {
+                m_currentSession = addSession();
+                m_apiTokenSessionIds[clientId()] = m_currentSession->id();
+            }
+            return;
+        }
+    }
+
     if (!m_currentSession && !isAuthNeeded())
         sessionStart();
 }
@@ -512,6 +647,15 @@ bool WebApplication::isAuthNeeded()
     return true;
 }
 
+bool WebApplication::isValidAPIToken(const QString &token) const
+{
+    if (m_apiTokenHash.isEmpty() || token.isEmpty())
+        return false;
+
+    const QByteArray tokenHash = QCryptographicHash::hash(token.toUtf8(), QCryptographicHash::Sha256).toHex();
+    return Utils::Password::slowEquals(tokenHash, m_apiTokenHash);
+}
+
 bool WebApplication::isPublicAPI(const QString &scope, const QString &action) const
 {
     return m_publicAPIs.contains(QString::fromLatin1("%1/%2").arg(scope, action));
@@ -521,19 +665,7 @@ void WebApplication::sessionStart()
 {
     Q_ASSERT(!m_currentSession);
 
-    // remove outdated sessions
-    Algorithm::removeIf(m_sessions, [this](const QString &, const WebSession *session)
-    {
-        if (session->hasExpired(m_sessionTimeout)) {
-            delete session;
-            return true;
-        }
-
-        return false;
-    });
-
-    m_currentSession = new WebSession(generateSid());
-    m_sessions[m_currentSession->id()] = m_currentSession;
+    m_currentSession = addSession();
 
     QNetworkCookie cookie(C_SID, m_currentSession->id().toUtf8());
     cookie.setHttpOnly(true);
@@ -552,12 +684,66 @@ void WebApplication::sessionEnd()
     cookie.setPath(QLatin1String("/"));
     cookie.setExpirationDate(QDateTime::currentDateTime().addDays(-1));
 
-    delete m_sessions.take(m_currentSession->id());
+    removeSession(m_currentSession);
     m_currentSession = nullptr;
 
     header(Http::HEADER_SET_COOKIE, cookie.toRawForm());
 }
 
+WebSession *WebApplication::addSession()
+{
+    removeExpiredSessions();
+
+    // Too many sessions from this client, drop its least recently used one
+    const QString client = clientId();
+    const auto clientQueueIter = m_clientSessionQueues.constFind(client);
+    if ((clientQueueIter != m_clientSessionQueues.cend()) && (static_cast<int>(clientQueueIter->size()) >= MAX_SESSIONS_PER_CLIENT))
+        removeSession(clientQueueIter->front());
+
+    auto *session = new WebSession(generateSid(), client);
+    m_sessions[session->id()] = session;
+
+    std::list<WebSession *> &clientQueue = m_clientSessionQueues[client];
+    session->m_queueIter = m_sessionQueue.insert(m_sessionQueue.end(), session);
+    session->m_clientQueueIter = clientQueue.insert(clientQueue.end(), session);
+
+    return session;
+}
+
+void WebApplication::touchSession(WebSession *session)
+{
+    session->updateTimestamp();
+
+    // move to the back of the queues, iterators stay valid
+    m_sessionQueue.splice(m_sessionQueue.end(), m_sessionQueue, session->m_queueIter);
+    std::list<WebSession *> &clientQueue = m_clientSessionQueues[session->m_clientId];
+    clientQueue.splice(clientQueue.end(), clientQueue, session->m_clientQueueIter);
+}
+
+void WebApplication::removeSession(WebSession *session)
+{
+    m_sessions.remove(session->id());
+    m_sessionQueue.erase(session->m_queueIter);
+
+    const auto tokenSessionIter = m_apiTokenSessionIds.find(session->m_clientId);
+    if ((tokenSessionIter != m_apiTokenSessionIds.end()) && (tokenSessionIter.value() == session->id()))
+        m_apiTokenSessionIds.erase(tokenSessionIter);
+
+    const auto clientQueueIter = m_clientSessionQueues.find(session->m_clientId);
+    clientQueueIter->erase(session->m_clientQueueIter);
+    if (clientQueueIter->empty())
+        m_clientSessionQueues.erase(clientQueueIter);
+
+    delete session;
+}
+
+void WebApplication::removeExpiredSessions()
+{
+    // the queue is ordered by expiry, so only expired sessions are ever visited
+    while (!m_sessionQueue.empty() && m_sessionQueue.front()->hasExpired(m_sessionTimeout))
+        removeSession(m_sessionQueue.front());
+}
+
 bool WebApplication::isCrossSiteRequest(const Http::Request &request) const
 {
     // https://www.owasp.org/index.php/Cross-Site_Request_Forgery_(CSRF)_Prevention_Cheat_Sheet#Verifying_Same_Origin_with_Standard_Headers
@@ -638,8 +824,9 @@ bool WebApplication::validateHostHeader(const QStringList &domains) const
 
 // WebSession
 
-WebSession::WebSession(const QString &sid)
+WebSession::WebSession(const QString &sid, const QString &clientId)
     : m_sid {sid}
+    , m_clientId {clientId}
 {
     updateTimestamp();
 }
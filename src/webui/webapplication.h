@@ -28,14 +28,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QRegularExpression>
 #include <QSet>
+#include <QThreadPool>
 #include <QTranslator>
 
+#include "api/apicontroller.h"
 #include "api/isessionmanager.h"
 #include "base/http/irequesthandler.h"
 #include "base/http/responsebuilder.h"
@@ -43,17 +51,23 @@
 #include "base/utils/net.h"
 #include "base/utils/version.h"
 
-constexpr Utils::Version<int, 3, 2> API_VERSION {2, 2, 0};
+constexpr Utils::Version<int, 3, 2> API_VERSION {2, 13, 0};
 
-class APIController;
 class WebApplication;
 
+namespace Http
+{
+    class DeferredResponse;
+}
+
 constexpr char C_SID[] = "SID"; // name of session id cookie
 
 class WebSession : public ISession
 {
+    friend class WebApplication;
+
 public:
-    explicit WebSession(const QString &sid);
+    WebSession(const QString &sid, const QString &clientId);
 
     QString id() const override;
 
@@ -65,8 +79,13 @@ public:
 
 private:
     const QString m_sid;
+    const QString m_clientId;
     QElapsedTimer m_timer;  // timestamp
     QVariantHash m_data;
+
+    // positions in the WebApplication session queues
+    std::list<WebSession *>::iterator m_queueIter;
+    std::list<WebSession *>::iterator m_clientQueueIter;
 };
 
 class WebApplication
@@ -95,8 +114,13 @@ public:
     const Http::Request &request() const;
     const Http::Environment &env() const;
 
+private slots:
+    void finishAsyncJob(int id, const QVariant &result);
+    void handleAsyncJobTimeout(int id);
+
 private:
     void doProcessRequest();
+    Http::Response startAsyncJob();
     void configure();
 
     void registerAPIController(const QString &scope, APIController *controller);
@@ -110,7 +134,12 @@ private:
     // Session management
     QString generateSid() const;
     void sessionInitialize();
+    WebSession *addSession();
+    void touchSession(WebSession *session);
+    void removeSession(WebSession *session);
+    void removeExpiredSessions();
     bool isAuthNeeded();
+    bool isValidAPIToken(const QString &token) const;
     bool isPublicAPI(const QString &scope, const QString &action) const;
 
     bool isCrossSiteRequest(const Http::Request &request) const;
@@ -118,9 +147,30 @@ private:
 
     // Persistent data
     QHash<QString, WebSession *> m_sessions;
+    // Sessions ordered by last access time, oldest first. All sessions share
+    // the same timeout, so this is also the order in which they expire.
+    std::list<WebSession *> m_sessionQueue;
+    QHash<QString, std::list<WebSession *>> m_clientSessionQueues;
+    QHash<QString, QString> m_apiTokenSessionIds;  // client address -> session ID
+
+    // Requests waiting for an API controller job running on the worker pool
+    struct PendingRequest
+    {
+        Http::Request request;
+        Http::Environment env;
+        QPointer<Http::DeferredResponse> response;
+        std::function<void ()> finishedHandler;
+        APIController::AsyncTimeoutPolicy timeoutPolicy;
+        std::shared_ptr<std::atomic_bool> isCancelled;  // shared with the job runner
+    };
+    QHash<int, PendingRequest> m_pendingRequests;
+    int m_lastAsyncJobId = 0;
+    QThreadPool m_workerPool;
 
     // Current data
     WebSession *m_currentSession = nullptr;
+    APIController::AsyncTask m_asyncTask;
+    QVariant m_asyncResult;
     Http::Request m_request;
     Http::Environment m_env;
     QHash<QString, QString> m_params;
@@ -148,6 +198,7 @@ private:
     bool m_isAuthSubnetWhitelistEnabled;
     QVector<Utils::Net::Subnet> m_authSubnetWhitelist;
     int m_sessionTimeout;
+    QByteArray m_apiTokenHash;
 
     // security related
     QStringList m_domainList;
@@ -79,6 +79,7 @@ void WebUI::configure()
                     || (m_httpServer->serverPort() != m_port))
                 m_httpServer->close();
         }
+        m_httpServer->setIOThreadCount(pref->getWebUIIOThreadCount());
 
         if (pref->isWebUiHttpsEnabled()) {
             const auto readData = [](const QString &path) -> QByteArray
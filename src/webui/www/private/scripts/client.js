@@ -636,6 +636,9 @@ window.addEvent('load', function() {
             $('QueuedIOJobs').set('html', serverState.queued_io_jobs);
             $('AverageTimeInQueue').set('html', serverState.average_time_queue + " ms");
             $('TotalQueuedSize').set('html', friendlyUnit(serverState.total_queued_size, false));
+            $('DiskReadRate').set('html', friendlyUnit(serverState.disk_read_rate, true));
+            $('DiskWriteRate').set('html', friendlyUnit(serverState.disk_write_rate, true));
+            $('HashRate').set('html', friendlyUnit(serverState.hash_rate, true));
         }
 
         if (serverState.connection_status == "connected")